@@ -0,0 +1,309 @@
+/******************************************************************************
+ * clustering_benchmark.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "clustering/labelpropagation.h"
+#include "clustering/louvainmethod.h"
+#include "clustering/nodereordering.h"
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
+#include "data_structure/graph_access.h"
+#include "graph_io.h"
+#include "configuration.h"
+#include "random_functions.h"
+#include "timer.h"
+#include "tools/modularitymetric.h"
+
+// counts the last level cache misses of this process (hardware counter),
+// not available if the kernel does not allow perf events
+class cache_miss_counter {
+public:
+        cache_miss_counter() : fd(-1) {
+#ifdef __linux__
+                struct perf_event_attr attr;
+                memset(&attr, 0, sizeof(attr));
+                attr.type           = PERF_TYPE_HARDWARE;
+                attr.size           = sizeof(attr);
+                attr.config         = PERF_COUNT_HW_CACHE_MISSES;
+                attr.disabled       = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv     = 1;
+                fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+
+        ~cache_miss_counter() {
+#ifdef __linux__
+                if( fd >= 0 ) close(fd);
+#endif
+        }
+
+        bool available() const { return fd >= 0; }
+
+        void start() {
+#ifdef __linux__
+                if( fd < 0 ) return;
+                ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        }
+
+        long long stop() {
+                long long count = 0;
+#ifdef __linux__
+                if( fd < 0 ) return 0;
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                if( read(fd, &count, sizeof(count)) != sizeof(count) ) count = 0;
+#endif
+                return count;
+        }
+
+private:
+        int fd;
+};
+
+// node reorderings: time and cache misses of label propagation sweeps
+// on the reordered graph and time of a complete Louvain clustering
+static void benchmark_reordering(PartitionConfig config, graph_access & G, int repetitions) {
+        ClusteringGraph input;
+        input.build(G);
+        config.lm_number_of_label_propagation_iterations = 1;
+
+        cache_miss_counter counter;
+        if( !counter.available() ) {
+                std::cout <<  "hardware cache miss counter not available" << std::endl;
+        }
+
+        const NodeReorderingType types[] = { NO_NODEREORDERING, DEGREE_NODEREORDERING, BFS_NODEREORDERING,
+                                             RCM_NODEREORDERING, CLUSTER_NODEREORDERING };
+        const char *names[] = { "none", "degree", "bfs", "rcm", "cluster" };
+
+        std::cout <<  "ordering \t reorder [s] \t lp sweep [s] \t lp cache misses \t louvain [s] \t modularity" << std::endl;
+
+        for( unsigned t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+                config.lm_node_reordering = types[t];
+
+                // reorder the input graph
+                timer time;
+                ClusteringGraph reordered;
+                std::vector<NodeID> newID;
+                std::vector<PartitionID> clustering(input.number_of_nodes());
+                for( NodeID node = 0; node < clustering.size(); node++) clustering[node] = node;
+
+                random_functions::setSeed(config.seed);
+                const ClusteringGraph *current = &input;
+                if( NodeReordering::computeOrdering(config, input, clustering, newID) ) {
+                        NodeReordering::reorder(input, newID, reordered);
+                        current = &reordered;
+                }
+                double reorder_time = time.elapsed();
+
+                // label propagation sweeps starting from singletons
+                double sweep_time   = 0;
+                long long misses    = 0;
+                for( int i = 0; i < repetitions; i++) {
+                        for( NodeID node = 0; node < clustering.size(); node++) clustering[node] = node;
+
+                        time.restart();
+                        counter.start();
+                        LabelPropagation::performLabelPropagation(config, *current, clustering);
+                        misses     += counter.stop();
+                        sweep_time += time.elapsed();
+                }
+
+                // complete Louvain clustering, the reordering is applied to each level
+                random_functions::setSeed(config.seed);
+                time.restart();
+                LouvainMethod lm;
+                lm.performClusteringWithLPP(config, &G);
+                double louvain_time = time.elapsed();
+
+                std::cout <<  names[t]
+                          <<  " \t " << reorder_time
+                          <<  " \t " << sweep_time / repetitions
+                          <<  " \t " << (counter.available() ? misses / repetitions : -1)
+                          <<  " \t " << louvain_time
+                          <<  " \t " << ModularityMetric::computeModularity(G) << std::endl;
+        }
+}
+
+// visiting order of the local moves: random permutation of all nodes
+// against block randomized orders, averaged over several seeds
+static void benchmark_visit_order(PartitionConfig config, graph_access & G, int repetitions) {
+        const unsigned block_edges[] = { 0, 4096, 16384, 65536 };
+
+        std::cout <<  "visit block edges \t louvain [s] \t modularity (average of " << repetitions << " seeds)" << std::endl;
+
+        for( unsigned b = 0; b < sizeof(block_edges) / sizeof(block_edges[0]); b++) {
+                config.lm_visit_block_edges = block_edges[b];
+
+                double louvain_time = 0, modularity = 0;
+                for( int seed = 0; seed < repetitions; seed++) {
+                        random_functions::setSeed(seed);
+                        timer time;
+                        LouvainMethod lm;
+                        lm.performClusteringWithLPP(config, &G);
+                        louvain_time += time.elapsed();
+                        modularity   += ModularityMetric::computeModularity(G);
+                }
+
+                std::cout <<  block_edges[b]
+                          <<  " \t " << louvain_time / repetitions
+                          <<  " \t " << modularity / repetitions << std::endl;
+        }
+}
+
+// coarsening guard: no check, stop at a level that shrinks the graph less than
+// by the factor 1.1, or aggregate such a level by label propagation
+static void benchmark_shrink_guard(PartitionConfig config, graph_access & G) {
+        const double shrink_factors[] = { 1.0, 1.1, 1.1 };
+        const LowShrinkActionType actions[] = { STOP_LOWSHRINK, STOP_LOWSHRINK, LABEL_PROPAGATION_LOWSHRINK };
+        const char *action_names[] = { "none", "stop", "lp" };
+
+        for( unsigned a = 0; a < sizeof(actions) / sizeof(actions[0]); a++) {
+                config.lm_minimum_shrink_factor = shrink_factors[a];
+                config.lm_low_shrink_action     = actions[a];
+
+                random_functions::setSeed(config.seed);
+                timer time;
+                LouvainMethod lm;
+                lm.performClusteringWithLPP(config, &G);
+
+                std::cout <<  "low shrink action " << action_names[a]
+                          <<  " \t louvain [s] " << time.elapsed()
+                          <<  " \t modularity " << ModularityMetric::computeModularity(G) << std::endl;
+                lm.printLevelStatistics(std::cout);
+        }
+}
+
+// compressed adjacency: bytes per directed edge of the graph representations, time of a
+// label propagation sweep and of the modularity computation and a complete Louvain clustering
+// on a ClusteringGraph against a CompressedGraph read directly from the file
+static void benchmark_compressed(PartitionConfig config, graph_access & G, const std::string & graph_filename, int repetitions) {
+        ClusteringGraph input;
+        input.build(G);
+        config.lm_number_of_label_propagation_iterations = 1;
+
+        CompressedGraph compressed;
+        timer time;
+        if( compressed.read(graph_filename) ) {
+                return;
+        }
+        double read_time = time.elapsed();
+
+        // graph_access keeps the nodes and edges twice (refinement and coarsening data)
+        size_t graph_access_bytes = (size_t) G.number_of_edges() * (sizeof(Edge) + sizeof(coarseningEdge))
+                                  + (size_t) (G.number_of_nodes() + 1) * (sizeof(Node) + sizeof(refinementNode));
+        double edges = std::max<EdgeID>(G.number_of_edges(), 1);
+
+        std::cout <<  "bytes per edge: graph_access " << graph_access_bytes / edges
+                  <<  " \t clustering graph " << input.memoryBytes() / edges
+                  <<  " \t compressed " << compressed.memoryBytes() / edges
+                  <<  " (read " << read_time << " s)" << std::endl;
+
+        std::cout <<  "graph \t lp sweep [s] \t modularity [s] \t louvain [s] \t modularity" << std::endl;
+
+        for( int c = 0; c < 2; c++) {
+                std::vector<PartitionID> clustering(G.number_of_nodes());
+
+                // label propagation sweeps starting from singletons
+                double sweep_time = 0, modularity_time = 0;
+                for( int i = 0; i < repetitions; i++) {
+                        for( NodeID node = 0; node < clustering.size(); node++) clustering[node] = node;
+
+                        random_functions::setSeed(config.seed);
+                        time.restart();
+                        if( c == 0 ) LabelPropagation::performLabelPropagation(config, input, clustering);
+                        else         LabelPropagation::performLabelPropagation(config, compressed, clustering);
+                        sweep_time += time.elapsed();
+
+                        time.restart();
+                        if( c == 0 ) ModularityMetric::computeModularity(input, clustering);
+                        else         ModularityMetric::computeModularity(compressed, clustering);
+                        modularity_time += time.elapsed();
+                }
+
+                // complete Louvain clustering
+                random_functions::setSeed(config.seed);
+                time.restart();
+                LouvainMethod lm;
+                if( c == 0 ) {
+                        lm.performClusteringWithLPP(config, &G);
+                } else {
+                        lm.performClustering(config, compressed, clustering);
+                }
+                double louvain_time = time.elapsed();
+                double modularity   = c == 0 ? ModularityMetric::computeModularity(G)
+                                      : ModularityMetric::computeModularity(compressed, clustering);
+
+                std::cout <<  (c == 0 ? "clustering graph" : "compressed")
+                          <<  " \t " << sweep_time / repetitions
+                          <<  " \t " << modularity_time / repetitions
+                          <<  " \t " << louvain_time
+                          <<  " \t " << modularity << std::endl;
+        }
+}
+
+// benchmarks of the Louvain kernels on one graph, the sections are selected on
+// the command line (default: all), every section starts from the standard configuration
+int main(int argn, char **argv) {
+
+        const char *sections[] = { "reordering", "visit_order", "shrink_guard", "compressed" };
+        const unsigned no_sections = sizeof(sections) / sizeof(sections[0]);
+
+        std::set<std::string> selected;
+        int repetitions = 5;
+        bool usage      = argn < 2;
+        for( int i = 2; i < argn && !usage; i++) {
+                std::string arg(argv[i]);
+                if( arg.compare(0, 14, "--repetitions=") == 0 ) {
+                        repetitions = atoi(arg.c_str() + 14);
+                        continue;
+                }
+                usage = std::find(sections, sections + no_sections, arg) == sections + no_sections;
+                selected.insert(arg);
+        }
+
+        if( usage ) {
+                std::cout <<  "Usage: clustering_benchmark GRAPHFILE [--repetitions=N] [SECTION ...]"  << std::endl;
+                std::cout <<  "sections: reordering visit_order shrink_guard compressed (default: all)"  << std::endl;
+                exit(0);
+        }
+        if( repetitions < 1 ) repetitions = 1;
+        if( selected.empty() ) selected.insert(sections, sections + no_sections);
+
+        std::string graph_filename(argv[1]);
+        graph_access G;
+        if( graph_io::readGraph(G, graph_filename) ) {
+                return 1;
+        }
+
+        PartitionConfig config;
+        configuration cfg;
+        cfg.standard(config);
+
+        std::cout << std::setprecision(4);
+        if( selected.count("reordering") )   benchmark_reordering(config, G, repetitions);
+        if( selected.count("visit_order") )  benchmark_visit_order(config, G, repetitions);
+        if( selected.count("shrink_guard") ) benchmark_shrink_guard(config, G);
+        if( selected.count("compressed") )   benchmark_compressed(config, G, graph_filename, repetitions);
+
+        return 0;
+}
@@ -279,6 +279,30 @@ inline void configuration::standard( PartitionConfig & partition_config ) {
         partition_config.lm_number_of_label_propagation_iterations = 3;
         partition_config.lm_number_of_label_propagation_levels = 0;
         partition_config.lm_cluster_coarsening_factor = 0;
+        partition_config.lm_node_reordering = NO_NODEREORDERING;
+        partition_config.lm_visit_block_edges = 0;
+        partition_config.lm_objective = MODULARITY_OBJECTIVE;
+        partition_config.lm_resolution = 1.0;
+        partition_config.lm_exact_gains = false;
+        partition_config.lm_heavy_node_degree = 0;
+        partition_config.lm_heavy_node_sample = 0;
+        partition_config.lm_minimum_shrink_factor = 1.0;
+        partition_config.lm_low_shrink_action = STOP_LOWSHRINK;
+        partition_config.lm_fm_refinement = false;
+        partition_config.lm_fm_rounds = 3;
+        partition_config.lm_fm_search_depth = 100;
+        partition_config.binary_partition_output = false;
+        partition_config.input_edge_list = false;
+        partition_config.compressed_graph = false;
+        partition_config.reduce_graph = false;
+        partition_config.reduce_graph_trees = false;
+        partition_config.reduce_graph_twins = false;
+        partition_config.split_components = false;
+        partition_config.mh_coarsening_levels = 0;
+        partition_config.mh_coarsening_minimum_nodes = 5000;
+        partition_config.mh_consensus_interval = 0;
+        partition_config.mh_deterministic = false;
+        partition_config.mh_deterministic_rounds = 100;
 
         partition_config.filename_output                        = "";
         partition_config.seed                                   = 0;
@@ -312,6 +336,8 @@ inline void configuration::standard( PartitionConfig & partition_config ) {
         partition_config.time_limit 				= 0; 
         partition_config.mh_pool_size                           = 100;
         partition_config.mh_mutate_fraction                     = 0.1;
+        partition_config.mh_mutate_light_split                  = false;
+        partition_config.mh_partition_cache_reuse               = 0;
         partition_config.mh_plain_repetitions                   = false;
         partition_config.no_unsuc_reps				= 10;
         partition_config.local_partitioning_repetitions 	= 1;
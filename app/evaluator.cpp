@@ -5,6 +5,9 @@
  *****************************************************************************/
 
 #include <argtable3.h>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <regex.h>
 #include <string.h>
 
@@ -17,6 +20,45 @@
 #include "quality_metrics.h"
 
 
+struct partition_stats {
+        bool valid;
+        double modularity;
+        NodeID clusters;
+        NodeID min_cluster_size;
+        NodeID max_cluster_size;
+        double avg_cluster_size;
+        NodeID singletons;
+};
+
+// machine readable statistics of one clustering, only reads G
+static void compute_stats(graph_access & G, const std::vector<PartitionID> & clustering, partition_stats & stats) {
+        PartitionID max_id = 0;
+        for( NodeID node = 0; node < clustering.size(); node++) {
+                max_id = std::max(max_id, clustering[node]);
+        }
+
+        std::vector<NodeID> sizes(max_id + 1, 0);
+        for( NodeID node = 0; node < clustering.size(); node++) {
+                sizes[clustering[node]]++;
+        }
+
+        stats.valid            = true;
+        stats.modularity       = ModularityMetric::computeModularity(G, clustering);
+        stats.clusters         = 0;
+        stats.min_cluster_size = std::numeric_limits<NodeID>::max();
+        stats.max_cluster_size = 0;
+        stats.singletons       = 0;
+        for( PartitionID block = 0; block < sizes.size(); block++) {
+                if(sizes[block] == 0) continue;
+                stats.clusters++;
+                stats.min_cluster_size = std::min(stats.min_cluster_size, sizes[block]);
+                stats.max_cluster_size = std::max(stats.max_cluster_size, sizes[block]);
+                if(sizes[block] == 1) stats.singletons++;
+        }
+        if(stats.clusters == 0) stats.min_cluster_size = 0;
+        stats.avg_cluster_size = stats.clusters > 0 ? clustering.size() / (double) stats.clusters : 0;
+}
+
 int main(int argn, char **argv) {
 
         PartitionConfig partition_config;
@@ -37,21 +79,69 @@ int main(int argn, char **argv) {
         }
 
         graph_access G;
-        graph_io::readGraphWeighted(G, graph_filename);
+        if(partition_config.input_edge_list) {
+                if(graph_io::readEdgeList(G, graph_filename)) {
+                        exit(0);
+                }
+        } else {
+                if(graph_io::readGraph(G, graph_filename)) {
+                        exit(0);
+                }
+        }
 
         G.set_partition_count(partition_config.k);
 
-        std::vector<PartitionID> input_partition;
-        if(partition_config.input_partition != "") {
-                //std::cout <<  "reading input partition" << std::endl;
-                graph_io::readPartition(G, partition_config.input_partition);
-        } else {
+        if(partition_config.input_partitions.empty()) {
                 std::cout <<  "Please specify an input partition using the --input_partition."  << std::endl;
                 exit(0);
         }
 
-        quality_metrics qm;
+        // the graph is loaded once, all partitions are evaluated on it in parallel
+        const std::vector<std::string> & files = partition_config.input_partitions;
+        int num_files = files.size();
+        std::vector<partition_stats> stats(num_files);
+
+        #pragma omp parallel for schedule(dynamic,1)
+        for( int i = 0; i < num_files; i++) {
+                std::vector<PartitionID> clustering;
+                if(graph_io::readPartition(files[i], G.number_of_nodes(), clustering)) {
+                        stats[i].valid = false;
+                        continue;
+                }
+                compute_stats(G, clustering, stats[i]);
+        }
+
+        for( int i = 0; i < num_files; i++) {
+                if(!stats[i].valid) {
+                        std::cerr << "could not evaluate partition " << files[i] << std::endl;
+                        continue;
+                }
+                if(num_files > 1) {
+                        std::cout << files[i] << std::endl;
+                }
+                std::cout << "modularity: \t\t" << stats[i].modularity << std::endl;
+                if(num_files > 1) {
+                        std::cout << "clusters: \t\t" << stats[i].clusters << std::endl;
+                }
+        }
 
-        //std::cout << "cut \t\t\t"         << qm.edge_cut(G)                 << std::endl;
-        std::cout << "modularity: \t\t" << ModularityMetric::computeModularity(G) << std::endl;
+        if(partition_config.filename_output != "") {
+                std::ofstream f(partition_config.filename_output.c_str());
+                if(!f) {
+                        std::cerr << "Error opening " << partition_config.filename_output << std::endl;
+                        return 1;
+                }
+                f << std::setprecision(10);
+                f << "partition,modularity,clusters,min_cluster_size,max_cluster_size,avg_cluster_size,singletons" << std::endl;
+                for( int i = 0; i < num_files; i++) {
+                        if(!stats[i].valid) continue;
+                        f << files[i]                  << ","
+                          << stats[i].modularity       << ","
+                          << stats[i].clusters         << ","
+                          << stats[i].min_cluster_size << ","
+                          << stats[i].max_cluster_size << ","
+                          << stats[i].avg_cluster_size << ","
+                          << stats[i].singletons       << std::endl;
+                }
+        }
 }
@@ -19,9 +19,14 @@
 
 #include "algorithms/cycle_search.h"
 #include "balance_configuration.h"
+#include "clustering/graphreduction.h"
+#include "clustering/louvainmethod.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include "graph_io.h"
 #include "macros_assertions.h"
+#include "parallel_mh_clustering/component_clustering.h"
+#include "parallel_mh_clustering/multilevel_mh_clustering.h"
 #include "parallel_mh_clustering/parallel_mh_async_clustering.h"
 #include "parse_parameters.h"
 #include "partition/graph_partitioner.h"
@@ -29,6 +34,49 @@
 #include "quality_metrics.h"
 #include "random_functions.h"
 #include "timer.h"
+#include "tools/modularitymetric.h"
+
+// clusters a graph that is read into a CompressedGraph by the Louvain method,
+// the evolutionary algorithm needs the graph as graph_access
+static void cluster_compressed(PartitionConfig & partition_config, std::string graph_filename) {
+        CompressedGraph G;
+
+        timer t;
+        if(G.read(graph_filename)) {
+                return;
+        }
+
+        std::cout << "io time: " << t.elapsed()  << std::endl;
+        std::cout << "compressed graph: " << G.memoryBytes() << " bytes, "
+                  << (double) G.memoryBytes() / std::max<EdgeID>(G.number_of_edges(), 1) << " bytes per edge" << std::endl;
+#ifdef _OPENMP
+        omp_set_num_threads(1);
+#endif
+        t.restart();
+
+        std::vector<PartitionID> clustering;
+        LouvainMethod louvain;
+        PartitionID k = louvain.performClustering(partition_config, G, clustering);
+
+        std::cout << "time spent " << t.elapsed()  << std::endl;
+        std::cout << "clusters \t\t\t" << k << std::endl;
+        std::cout << "modularity \t\t\t" << ModularityMetric::computeModularity(G, clustering) << std::endl;
+
+        // write the partition to the disc 
+        std::stringstream filename;
+        if(!partition_config.filename_output.compare("")) {
+                // no output filename given
+                filename << "tmpclustering";
+        } else {
+                filename << partition_config.filename_output;
+        }
+
+        if(partition_config.binary_partition_output) {
+                graph_io::writePartitionBinary(clustering, filename.str());
+        } else {
+                graph_io::writePartition(clustering, filename.str());
+        }
+}
 
 int main(int argn, char **argv) {
 
@@ -53,10 +101,35 @@ int main(int argn, char **argv) {
                 return 0;
         }
 
+        if(partition_config.compressed_graph) {
+                if(partition_config.input_edge_list) {
+                        std::cerr << "--compressed_graph does not support edge lists" << std::endl;
+                        MPI_Finalize();
+                        return 0;
+                }
+
+                int rank;
+                MPI_Comm_rank( MPI_COMM_WORLD, &rank);
+                if( rank == ROOT ) {
+                        cluster_compressed(partition_config, graph_filename);
+                }
+
+                MPI_Finalize();
+                return 0;
+        }
+
         graph_access G;     
 
         timer t;
-        graph_io::readGraphWeighted(G, graph_filename);
+        if(partition_config.input_edge_list) {
+                if(graph_io::readEdgeList(G, graph_filename)) {
+                        exit(0);
+                }
+        } else {
+                if(graph_io::readGraph(G, graph_filename)) {
+                        exit(0);
+                }
+        }
 
         std::cout << "io time: " << t.elapsed()  << std::endl;
 #ifdef _OPENMP
@@ -65,8 +138,33 @@ int main(int argn, char **argv) {
         t.restart();
         
         partition_config.k = 1;
-        parallel_mh_async_clustering mh;
-        mh.perform_partitioning(partition_config, G);
+
+        // the evolutionary algorithm runs on the reduced graph,
+        // the clustering is lifted back afterwards
+        graph_access reduced;
+        std::vector<NodeID> reduction_mapping;
+        if(partition_config.reduce_graph) {
+                GraphReduction::reduce(partition_config, G, reduced, reduction_mapping);
+                std::cout << "reduced graph: nodes " << G.number_of_nodes() << " -> " << reduced.number_of_nodes()
+                          << ", edges " << G.number_of_edges() << " -> " << reduced.number_of_edges()
+                          << ", time " << t.elapsed() << std::endl;
+        }
+
+        graph_access & H = partition_config.reduce_graph ? reduced : G;
+        if(partition_config.split_components) {
+                component_clustering cc;
+                cc.perform_clustering(partition_config, H);
+        } else if(partition_config.mh_coarsening_levels > 0) {
+                multilevel_mh_clustering mh;
+                mh.perform_partitioning(partition_config, H);
+        } else {
+                parallel_mh_async_clustering mh;
+                mh.perform_partitioning(partition_config, H);
+        }
+
+        if(partition_config.reduce_graph) {
+                GraphReduction::liftClustering(reduced, reduction_mapping, G);
+        }
 
         int rank, size;
         MPI_Comm communicator = MPI_COMM_WORLD; 
@@ -87,7 +185,11 @@ int main(int argn, char **argv) {
                         filename << partition_config.filename_output;
                 }
 
-                graph_io::writePartition(G, filename.str());
+                if(partition_config.binary_partition_output) {
+                        graph_io::writePartitionBinary(G, filename.str());
+                } else {
+                        graph_io::writePartition(G, filename.str());
+                }
         }
 
         MPI_Finalize();
@@ -0,0 +1,43 @@
+/******************************************************************************
+ * graph2binary.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering 
+ *****************************************************************************/
+
+#include <iostream>
+#include <string>
+
+#include "data_structure/graph_access.h"
+#include "graph_io.h"
+#include "timer.h"
+
+// converts a graph in METIS format into the binary graph format 
+// that can be loaded by VieClus without parsing
+int main(int argn, char **argv) {
+
+        if( argn != 3 ) {
+                std::cout <<  "Usage: graph2binary METISFILE OUTPUTFILE"  << std::endl;
+                exit(0);
+        }
+
+        std::string graph_filename(argv[1]);
+        std::string output_filename(argv[2]);
+
+        graph_access G;
+
+        timer t;
+        if( graph_io::readGraphWeightedParallel(G, graph_filename) ) {
+                return 1;
+        }
+        std::cout <<  "io time: " << t.elapsed()  << std::endl;
+
+        t.restart();
+        if( graph_io::writeGraphBinary(G, output_filename) ) {
+                return 1;
+        }
+        std::cout <<  "write time: " << t.elapsed()  << std::endl;
+        std::cout <<  "wrote " <<  G.number_of_nodes() << " nodes and " 
+                  <<  G.number_of_edges() << " directed edges to " <<  output_filename << std::endl;
+
+        return 0;
+}
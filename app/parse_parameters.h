@@ -17,6 +17,7 @@
 #include "tools/pseudo_mpi.h"
 #endif
 #include <sstream>
+#include <string.h>
 #include "configuration.h"
 
 int parse_parameters(int argn, char **argv,
@@ -33,9 +34,23 @@ int parse_parameters(int argn, char **argv,
         struct arg_dbl *mh_mutate_fraction                   = arg_dbl0(NULL, "mh_mutate_fraction", NULL, "Fraction to determine the number of clusters that will be split by the mutation operator.");
         struct arg_int *local_partitioning_repetitions       = arg_int0(NULL, "local_partitioning_repetitions", NULL, "Number of local repetitions.");
         struct arg_str *filename                             = arg_strn(NULL, NULL, "FILE", 1, 1, "Path to graph file to partition.");
-        struct arg_str *filename_output                      = arg_str0(NULL, "output_filename", NULL, "Specify the name of the output file (that contains the partition).");
+        struct arg_str *filename_output                      = arg_str0(NULL, "output_filename", NULL, "Specify the name of the output file (that contains the partition). The evaluator writes its statistics as CSV into it.");
+        struct arg_lit *binary_partition                     = arg_lit0(NULL, "binary_partition", "Write the clustering in the binary partition format. Default: text.");
+        struct arg_lit *edge_list                            = arg_lit0(NULL, "edge_list", "The graph file is an edge list (lines \"u v [weight]\", node IDs start at 0). Binary edge lists are detected automatically.");
+        struct arg_lit *compressed_graph                     = arg_lit0(NULL, "compressed_graph", "Read the graph into a compressed adjacency structure (gap-encoded targets, about 1-3 bytes per edge) and cluster it by the Louvain method (lm_ options) instead of the evolutionary algorithm. For graphs that do not fit into memory otherwise. Not for edge lists.");
+        struct arg_lit *reduce_graph                         = arg_lit0(NULL, "reduce_graph", "Fold pendant vertices (degree one, unit edge weight, no self loop) into their neighbor before clustering, this keeps the optimal clusterings. The clustering is lifted back to the input graph.");
+        struct arg_lit *reduce_graph_trees                   = arg_lit0(NULL, "reduce_graph_trees", "Heuristic, implies --reduce_graph: also fold weighted pendant vertices, dangling chains and trees. May exclude the optimal clusterings.");
+        struct arg_lit *reduce_graph_twins                   = arg_lit0(NULL, "reduce_graph_twins", "Heuristic, implies --reduce_graph: also merge structurally identical twins. May exclude the optimal clusterings.");
+        struct arg_lit *split_components                     = arg_lit0(NULL, "split_components", "Cluster the connected components independently: tiny components become one cluster, medium ones are clustered by the Louvain method, large ones by the evolutionary algorithm.");
+        struct arg_int *mh_coarsening_levels                 = arg_int0(NULL, "mh_coarsening_levels", NULL, "Coarsen the graph by this many levels of label propagation before the evolutionary algorithm and refine the clustering by node moves during uncoarsening. Default: 0 (no coarsening).");
+        struct arg_int *mh_coarsening_minimum_nodes          = arg_int0(NULL, "mh_coarsening_minimum_nodes", NULL, "The coarsening stops at this many nodes. The label propagation clusters are at most the total node weight divided by it. Default: 5000.");
+        struct arg_int *mh_consensus_interval                = arg_int0(NULL, "mh_consensus_interval", NULL, "Every this many rounds, contract the graph by the consensus of all individuals of the pool and continue on the contracted graph. Default: 0 (disabled).");
+        struct arg_lit *mh_mutate_light_split                = arg_lit0(NULL, "mh_mutate_light_split", "The mutation splits clusters by BFS and label propagation instead of the multilevel partitioner.");
+        struct arg_dbl *mh_partition_cache_reuse             = arg_dbl0(NULL, "mh_partition_cache_reuse", NULL, "Probability that the partitioning combine operator reuses one of the last 16 partitions of the PE instead of computing a new one. Default: 0 (no cache).");
+        struct arg_lit *mh_deterministic                     = arg_lit0(NULL, "mh_deterministic", "Reproducible evolutionary algorithm: runs mh_deterministic_rounds rounds instead of until the time limit, with a pool of mh_pool_size individuals. With one PE the same seed gives the same clustering for any number of threads. Default: disabled.");
+        struct arg_int *mh_deterministic_rounds              = arg_int0(NULL, "mh_deterministic_rounds", NULL, "Number of rounds of the evolutionary algorithm in deterministic mode. Default: 100.");
         struct arg_int *user_seed                            = arg_int0(NULL, "seed", NULL, "Seed to use for the PRNG.");
-        struct arg_str *input_partition                      = arg_str0(NULL, "input_partition", NULL, "Input partition to use.");
+        struct arg_str *input_partition                      = arg_strn(NULL, "input_partition", NULL, 0, 100000, "Input partition to use. The evaluator accepts this option multiple times.");
         struct arg_dbl *time_limit                           = arg_dbl1(NULL, "time_limit", NULL, "Time limit in s. Default 0s .");
         struct arg_lit *mh_print_log                         = arg_lit0(NULL, "mh_print_log", "Each PE prints a logfile (timestamp, edgecut).");
         struct arg_int *cluster_upperbound                   = arg_int0(NULL, "cluster_upperbound", NULL, "Set a size-constraint on the size of a cluster. Default: none");
@@ -46,9 +61,22 @@ int parse_parameters(int argn, char **argv,
         struct arg_int *lm_number_of_label_propagation_levels       = arg_int0(NULL, "lm_number_of_label_propagation_levels", NULL, "Number of label propagation levels used before the Louvain method. Default: 0.");
         struct arg_int *lm_number_of_label_propagation_iterations   = arg_int0(NULL, "lm_number_of_label_propagation_iterations", NULL, "Number of iterations per label propagation level. Default: 3.");
         struct arg_int *lm_cluster_coarsening_factor                = arg_int0(NULL, "lm_cluster_coarsening_factor", NULL, "Factor relative to the number of nodes that limits the maximum cluster size for size constrained label propagation. If this factor is 0 or 1, then no size constraint is used. Default: 0.");
+        struct arg_str *lm_node_reordering                          = arg_str0(NULL, "node_reordering", "TYPE", "Renumbering of the nodes of the input graph and of each coarse graph for a better memory locality. One of {none, degree, bfs, rcm, cluster}. Default: none.");
+        struct arg_int *lm_visit_block_edges                        = arg_int0(NULL, "visit_block_edges", NULL, "Visit the nodes in the local move phases block wise: blocks of about this many edges in random order, nodes inside a block in random order. 0 uses a random permutation of all nodes. Default: 0.");
+        struct arg_str *lm_objective                                = arg_str0(NULL, "objective", "TYPE", "Objective of the Louvain method. One of {modularity, cpm} (cpm is the constant Potts model). Default: modularity.");
+        struct arg_dbl *lm_resolution                               = arg_dbl0(NULL, "resolution", NULL, "Resolution parameter gamma of the objective of the Louvain method. Default: 1.");
+        struct arg_lit *lm_exact_gains                              = arg_lit0(NULL, "exact_gains", "Compare the modularity gains of the Louvain method as integers instead of floating point numbers (plain modularity only). Default: disabled.");
+        struct arg_int *lm_heavy_node_degree                        = arg_int0(NULL, "heavy_node_degree", NULL, "Nodes with more edges are heavy, their edges are aggregated in parallel chunks by label propagation, the Louvain method and the contraction. 0 disables it. Default: 0.");
+        struct arg_int *lm_heavy_node_sample                        = arg_int0(NULL, "heavy_node_sample", NULL, "Heavy nodes rate only a sample of about this many edges in the first sweep of each level (not exact). 0 disables it. Default: 0.");
+        struct arg_dbl *lm_minimum_shrink_factor                    = arg_dbl0(NULL, "minimum_shrink_factor", NULL, "A Louvain level whose number of nodes divided by its number of clusters is smaller shrinks too little, see low_shrink_action. Values <= 1 disable it. Default: 1.");
+        struct arg_str *lm_low_shrink_action                        = arg_str0(NULL, "low_shrink_action", "TYPE", "What to do on a Louvain level that shrinks too little. One of {stop, lp} (lp aggregates the level with label propagation and stops if that does not shrink enough either or lowers the objective). Default: stop.");
+        struct arg_lit *lm_fm_refinement                            = arg_lit0(NULL, "fm_refinement", "Refine each uncoarsening level (also of the multilevel combine) by FM with a gain priority queue, negative gains and rollback to the best quality. Default: disabled.");
+        struct arg_int *lm_fm_rounds                                = arg_int0(NULL, "fm_rounds", NULL, "Maximum number of FM rounds per level. Default: 3.");
+        struct arg_int *lm_fm_search_depth                          = arg_int0(NULL, "fm_search_depth", NULL, "An FM round stops after this many moves without improvement. Default: 100.");
         struct arg_str *output_log_json                             = arg_str0(NULL, "output_log_json", NULL, "File to write the log in JSON format into it. Use \"-\" to write to STDOUT. (Default: disabled)");
 
         struct arg_int *mh_pool_size                         = arg_int0(NULL, "mh_pool_size", NULL, "MetaHeuristic Pool Size.");
+        struct arg_lit *mh_enable_quickstart                 = arg_lit0(NULL, "mh_enable_quickstart", "Each PE creates only its share of the initial population, the pools are then filled by exchanging individuals. Default: disabled.");
         struct arg_end *end                                  = arg_end(100);
 
         // Define argtable.
@@ -56,14 +84,43 @@ int parse_parameters(int argn, char **argv,
                 help, filename, user_seed,
 #ifdef MODE_KAFFPAE
                 time_limit,
-                //mh_pool_size,
+                mh_enable_quickstart,
+                mh_pool_size,
                 //mh_mutate_fraction,
 		//mh_print_log, 
                 //local_partitioning_repetitions,
                 //input_partition,
                 filename_output,
+                binary_partition,
+                edge_list,
+                compressed_graph,
+                lm_node_reordering,
+                lm_visit_block_edges,
+                lm_objective,
+                lm_resolution,
+                lm_exact_gains,
+                lm_heavy_node_degree,
+                lm_heavy_node_sample,
+                lm_minimum_shrink_factor,
+                lm_low_shrink_action,
+                lm_fm_refinement,
+                lm_fm_rounds,
+                lm_fm_search_depth,
+                reduce_graph,
+                reduce_graph_trees,
+                reduce_graph_twins,
+                split_components,
+                mh_coarsening_levels,
+                mh_coarsening_minimum_nodes,
+                mh_consensus_interval,
+                mh_mutate_light_split,
+                mh_partition_cache_reuse,
+                mh_deterministic,
+                mh_deterministic_rounds,
 #elif defined MODE_EVALUATOR
                 input_partition,
+                filename_output,
+                edge_list,
 #elif defined MODE_CLUSTERING
     // for graph clustering we need some own parameters (by BSc)
     lm_minimum_quality_improvement,
@@ -71,6 +128,18 @@ int parse_parameters(int argn, char **argv,
     lm_number_of_label_propagation_iterations,
     // if we use size constrained label propagation
     lm_cluster_coarsening_factor,
+    lm_node_reordering,
+    lm_visit_block_edges,
+    lm_objective,
+    lm_resolution,
+    lm_exact_gains,
+    lm_heavy_node_degree,
+    lm_heavy_node_sample,
+    lm_minimum_shrink_factor,
+    lm_low_shrink_action,
+    lm_fm_refinement,
+    lm_fm_rounds,
+    lm_fm_search_depth,
     output_log_json,
 #endif
                 end
@@ -128,12 +197,77 @@ int parse_parameters(int argn, char **argv,
                 partition_config.time_limit = time_limit->dval[0];
         }
 
+        if(mh_enable_quickstart->count > 0) {
+                partition_config.mh_enable_quickstart = true;
+        }
+
         if(mh_pool_size->count > 0) {
                 partition_config.mh_pool_size = mh_pool_size->ival[0];
         }
 
         if(input_partition->count > 0) {
                 partition_config.input_partition = input_partition->sval[0];
+                for( int i = 0; i < input_partition->count; i++) {
+                        partition_config.input_partitions.push_back(input_partition->sval[i]);
+                }
+        }
+
+        if(binary_partition->count > 0) {
+                partition_config.binary_partition_output = true;
+        }
+
+        if(edge_list->count > 0) {
+                partition_config.input_edge_list = true;
+        }
+
+        if(compressed_graph->count > 0) {
+                partition_config.compressed_graph = true;
+        }
+
+        if(reduce_graph->count > 0) {
+                partition_config.reduce_graph = true;
+        }
+
+        if(reduce_graph_trees->count > 0) {
+                partition_config.reduce_graph       = true;
+                partition_config.reduce_graph_trees = true;
+        }
+
+        if(reduce_graph_twins->count > 0) {
+                partition_config.reduce_graph       = true;
+                partition_config.reduce_graph_twins = true;
+        }
+
+        if(split_components->count > 0) {
+                partition_config.split_components = true;
+        }
+
+        if(mh_coarsening_levels->count > 0) {
+                partition_config.mh_coarsening_levels = mh_coarsening_levels->ival[0];
+        }
+
+        if(mh_coarsening_minimum_nodes->count > 0) {
+                partition_config.mh_coarsening_minimum_nodes = mh_coarsening_minimum_nodes->ival[0];
+        }
+
+        if(mh_consensus_interval->count > 0) {
+                partition_config.mh_consensus_interval = mh_consensus_interval->ival[0];
+        }
+
+        if(mh_mutate_light_split->count > 0) {
+                partition_config.mh_mutate_light_split = true;
+        }
+
+        if(mh_deterministic->count > 0) {
+                partition_config.mh_deterministic = true;
+        }
+
+        if(mh_deterministic_rounds->count > 0) {
+                partition_config.mh_deterministic_rounds = mh_deterministic_rounds->ival[0];
+        }
+
+        if(mh_partition_cache_reuse->count > 0) {
+                partition_config.mh_partition_cache_reuse = mh_partition_cache_reuse->dval[0];
         }
 
         if (label_propagation_iterations->count > 0) {
@@ -163,6 +297,81 @@ int parse_parameters(int argn, char **argv,
             partition_config.lm_cluster_coarsening_factor = static_cast<unsigned>(lm_cluster_coarsening_factor->ival[0]);
         }
 
+        if (lm_node_reordering->count > 0) {
+            if (strcmp("none", lm_node_reordering->sval[0]) == 0) {
+                partition_config.lm_node_reordering = NO_NODEREORDERING;
+            } else if (strcmp("degree", lm_node_reordering->sval[0]) == 0) {
+                partition_config.lm_node_reordering = DEGREE_NODEREORDERING;
+            } else if (strcmp("bfs", lm_node_reordering->sval[0]) == 0) {
+                partition_config.lm_node_reordering = BFS_NODEREORDERING;
+            } else if (strcmp("rcm", lm_node_reordering->sval[0]) == 0) {
+                partition_config.lm_node_reordering = RCM_NODEREORDERING;
+            } else if (strcmp("cluster", lm_node_reordering->sval[0]) == 0) {
+                partition_config.lm_node_reordering = CLUSTER_NODEREORDERING;
+            } else {
+                fprintf(stderr, "Invalid node reordering: \"%s\"\n", lm_node_reordering->sval[0]);
+                exit(0);
+            }
+        }
+
+        if (lm_visit_block_edges->count > 0) {
+            partition_config.lm_visit_block_edges = static_cast<unsigned>(lm_visit_block_edges->ival[0]);
+        }
+
+        if (lm_objective->count > 0) {
+            if (strcmp("modularity", lm_objective->sval[0]) == 0) {
+                partition_config.lm_objective = MODULARITY_OBJECTIVE;
+            } else if (strcmp("cpm", lm_objective->sval[0]) == 0) {
+                partition_config.lm_objective = CPM_OBJECTIVE;
+            } else {
+                fprintf(stderr, "Invalid objective: \"%s\"\n", lm_objective->sval[0]);
+                exit(0);
+            }
+        }
+
+        if (lm_resolution->count > 0) {
+            partition_config.lm_resolution = lm_resolution->dval[0];
+        }
+
+        if (lm_exact_gains->count > 0) {
+            partition_config.lm_exact_gains = true;
+        }
+
+        if (lm_heavy_node_degree->count > 0) {
+            partition_config.lm_heavy_node_degree = lm_heavy_node_degree->ival[0];
+        }
+
+        if (lm_heavy_node_sample->count > 0) {
+            partition_config.lm_heavy_node_sample = lm_heavy_node_sample->ival[0];
+        }
+
+        if (lm_minimum_shrink_factor->count > 0) {
+            partition_config.lm_minimum_shrink_factor = lm_minimum_shrink_factor->dval[0];
+        }
+
+        if (lm_low_shrink_action->count > 0) {
+            if (strcmp("stop", lm_low_shrink_action->sval[0]) == 0) {
+                partition_config.lm_low_shrink_action = STOP_LOWSHRINK;
+            } else if (strcmp("lp", lm_low_shrink_action->sval[0]) == 0) {
+                partition_config.lm_low_shrink_action = LABEL_PROPAGATION_LOWSHRINK;
+            } else {
+                fprintf(stderr, "Invalid low shrink action: \"%s\"\n", lm_low_shrink_action->sval[0]);
+                exit(0);
+            }
+        }
+
+        if (lm_fm_refinement->count > 0) {
+            partition_config.lm_fm_refinement = true;
+        }
+
+        if (lm_fm_rounds->count > 0) {
+            partition_config.lm_fm_rounds = lm_fm_rounds->ival[0];
+        }
+
+        if (lm_fm_search_depth->count > 0) {
+            partition_config.lm_fm_search_depth = lm_fm_search_depth->ival[0];
+        }
+
         if (output_log_json->count > 0) {
             partition_config.outputLogJsonFileName = output_log_json->sval[0];
         }
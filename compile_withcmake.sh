@@ -27,4 +27,6 @@ mkdir deploy
 cp ./build/evolutionary_clustering deploy/vieclus
 cp ./build/evaluator deploy/
 cp ./build/graphchecker deploy/
+cp ./build/graph2binary deploy/
+cp ./build/clustering_benchmark deploy/
 
@@ -123,6 +123,29 @@ private:
         }
     }
 
+    // bulk construction from CSR offsets (offsets has size n+1)
+    // targets and weights of the edges are set afterwards by the caller
+    void build_from_offsets(NodeID n, const EdgeID* offsets) {
+        EdgeID m = offsets[n];
+
+        m_nodes.resize(n+1);
+        m_refinement_node_props.resize(n+1);
+        m_edges.resize(m);
+        m_coarsening_edge_props.resize(m);
+
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < (long long)n+1; i++) {
+                m_nodes[i].firstEdge                      = offsets[i];
+                m_nodes[i].weight                         = 1;
+                m_refinement_node_props[i].partitionIndex = 0;
+        }
+
+        node             = n;
+        e                = m;
+        m_last_source    = (int)n - 1;
+        m_building_graph = false;
+    }
+
     // %%%%%%%%%%%%%%%%%%% DATA %%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
     // split properties for coarsening and uncoarsening
     std::vector<Node> m_nodes;
@@ -152,7 +175,7 @@ class complete_boundary;
 class graph_access {
         friend class complete_boundary;
         public:
-                graph_access() { m_max_degree_computed = false; m_max_degree = 0; graphref = new basicGraph(); m_separator_block_ID = 2;}
+                graph_access() { m_max_degree_computed = false; m_max_degree = 0; graphref = new basicGraph(); m_separator_block_ID = 2; m_unit_edge_weights = false;}
                 virtual ~graph_access(){ delete graphref; };
 
                 /* ============================================================= */
@@ -163,6 +186,12 @@ class graph_access {
                 EdgeID new_edge(NodeID source, NodeID target);
                 void finish_construction();
 
+                /* bulk construction, e.g. for parallel graph readers: creates all nodes
+                 * (unit weight) and the edge slots given by the CSR offsets (size n+1).
+                 * Targets and weights have to be set via setEdgeTarget()/setEdgeWeight(). */
+                void build_from_csr_offsets(NodeID n, const std::vector<EdgeID> & offsets);
+                void build_from_csr_offsets(NodeID n, const EdgeID* offsets);
+
                 /* ============================================================= */
                 /* graph access methods */
                 /* ============================================================= */
@@ -198,6 +227,14 @@ class graph_access {
                 /// Self loops net to be allocated, if they were needed.
                 void resizeSelfLoops(NodeID size, EdgeWeight weight = 0);
 
+                /**
+                 *  \brief Returns TRUE if all edge weights are 1, as recorded by the graph
+                 *  readers for files without edge weights. Reset by a new construction,
+                 *  whoever changes the edge weights of such a graph has to reset it too.
+                 */
+                bool hasUnitEdgeWeights() const;
+                void setUnitEdgeWeights(bool unit);
+
 
                 NodeWeight getNodeWeight(NodeID node);
                 void setNodeWeight(NodeID node, NodeWeight weight);
@@ -210,6 +247,7 @@ class graph_access {
                 void setEdgeWeight(EdgeID edge, EdgeWeight weight);
 
                 NodeID getEdgeTarget(EdgeID edge);
+                void setEdgeTarget(EdgeID edge, NodeID target);
 
                 EdgeRatingType getEdgeRating(EdgeID edge);
                 void setEdgeRating(EdgeID edge, EdgeRatingType rating);
@@ -233,6 +271,7 @@ class graph_access {
                 unsigned int m_partition_count;
                 EdgeWeight   m_max_degree;
                 PartitionID  m_separator_block_ID;
+                bool         m_unit_edge_weights;
                 std::vector<PartitionID> m_second_partition_index;
 
                 std::vector<EdgeWeight> m_selfLoops;    /**< Weighted self loops of nodes.
@@ -248,6 +287,7 @@ class graph_access {
 
 /* graph build methods */
 inline void graph_access::start_construction(NodeID nodes, EdgeID edges) {
+        m_unit_edge_weights = false;
         graphref->start_construction(nodes, edges);
 }
 
@@ -263,6 +303,16 @@ inline void graph_access::finish_construction() {
         graphref->finish_construction();
 }
 
+inline void graph_access::build_from_csr_offsets(NodeID n, const std::vector<EdgeID> & offsets) {
+        build_from_csr_offsets(n, &offsets[0]);
+}
+
+inline void graph_access::build_from_csr_offsets(NodeID n, const EdgeID* offsets) {
+        graphref->build_from_offsets(n, offsets);
+        m_max_degree_computed = false;
+        m_unit_edge_weights   = false;
+}
+
 /* graph access methods */
 inline NodeID graph_access::number_of_nodes() {
         return graphref->number_of_nodes();
@@ -323,6 +373,18 @@ inline bool graph_access::containsSelfLoops() const
 }
 
 
+inline bool graph_access::hasUnitEdgeWeights() const
+{
+    return m_unit_edge_weights;
+}
+
+
+inline void graph_access::setUnitEdgeWeights(bool unit)
+{
+    m_unit_edge_weights = unit;
+}
+
+
 inline EdgeWeight graph_access::getSelfLoop(NodeID node) const
 {
 #ifdef NDEBUG
@@ -415,6 +477,14 @@ inline NodeID graph_access::getEdgeTarget(EdgeID edge){
 #endif
 }
 
+inline void graph_access::setEdgeTarget(EdgeID edge, NodeID target){
+#ifdef NDEBUG
+        graphref->m_edges[edge].target = target;
+#else
+        graphref->m_edges.at(edge).target = target;
+#endif
+}
+
 inline EdgeRatingType graph_access::getEdgeRating(EdgeID edge) {
 #ifdef NDEBUG
         return graphref->m_coarsening_edge_props[edge].rating;
@@ -566,6 +636,7 @@ inline void graph_access::copy(graph_access & G_bar) {
 
         G_bar.m_selfLoops = m_selfLoops;
         G_bar.finish_construction();
+        G_bar.m_unit_edge_weights = m_unit_edge_weights;
 }
 
 #endif /* end of include guard: GRAPH_ACCESS_EFRXO4X2 */
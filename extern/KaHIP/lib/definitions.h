@@ -153,6 +153,24 @@ typedef enum {
         DEGREE_NODEORDERING
 } NodeOrderingType;
 
+typedef enum {
+        NO_NODEREORDERING,
+        DEGREE_NODEREORDERING,
+        BFS_NODEREORDERING,
+        RCM_NODEREORDERING,
+        CLUSTER_NODEREORDERING
+} NodeReorderingType;
+
+typedef enum {
+        MODULARITY_OBJECTIVE,
+        CPM_OBJECTIVE
+} ClusteringObjectiveType;
+
+typedef enum {
+        STOP_LOWSHRINK,
+        LABEL_PROPAGATION_LOWSHRINK
+} LowShrinkActionType;
+
 typedef enum {
         NSQUARE, 
         NSQUAREPRUNED, 
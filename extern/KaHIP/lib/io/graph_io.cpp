@@ -4,7 +4,17 @@
  * Source of KaHIP -- Karlsruhe High Quality Partitioning.
  *****************************************************************************/
 
+#include <algorithm>
+#include <fcntl.h>
 #include <sstream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 #include "graph_io.h"
 
 graph_io::graph_io() {
@@ -47,33 +57,19 @@ int graph_io::writeGraph(graph_access & G, std::string filename) {
 }
 
 int graph_io::readPartition(graph_access & G, std::string filename) {
-        std::string line;
-
-        // open file for reading
-        std::ifstream in(filename.c_str());
-        if (!in) {
-                std::cerr << "Error opening file" << filename << std::endl;
+        std::vector<PartitionID> partition;
+        if( readPartition(filename, G.number_of_nodes(), partition) ) {
                 return 1;
         }
 
         PartitionID max = 0;
         forall_nodes(G, node) {
-                // fetch current line
-                std::getline(in, line);
-                if (line[0] == '%') { //Comment
-                        node--;
-                        continue;
-                }
-
-                // in this line we find the block of Node node
-                G.setPartitionIndex(node, (PartitionID) atol(line.c_str()));
-
-                if(G.getPartitionIndex(node) > max)
-                        max = G.getPartitionIndex(node);
+                G.setPartitionIndex(node, partition[node]);
+                if(partition[node] > max)
+                        max = partition[node];
         } endfor
 
         G.set_partition_count(max+1);
-        in.close();
 
         return 0;
 }
@@ -186,6 +182,7 @@ int graph_io::readGraphWeighted(graph_access & G, std::string filename) {
 
 
         G.finish_construction();
+        G.setUnitEdgeWeights(!read_ew);
         return 0;
 }
 
@@ -314,20 +311,1193 @@ int graph_io::readGraphWeightedFast(graph_access & G, std::string filename) {
 
 
         G.finish_construction();
+        G.setUnitEdgeWeights(!read_ew);
         return 0;
 }
 
 
 
+// helpers for the memory mapped parallel reader
+static inline bool is_digit(char c) {
+        return (unsigned)(c - '0') < 10u;
+}
+
+// skips separators and parses the next unsigned number in [p, end), returns 0 if there is none
+static inline unsigned long long parse_uint(const char* & p, const char* end) {
+        while( p < end && !is_digit(*p)) ++p;
+
+        unsigned long long x = 0;
+        while( p < end && is_digit(*p)) {
+                x = x*10 + (unsigned)(*p - '0');
+                ++p;
+        }
+        return x;
+}
+
+// counts the numbers in [begin, end) without branching on the characters
+static inline EdgeID count_numbers(const char* begin, const char* end) {
+        EdgeID numbers = 0;
+        bool prev      = false;
+        for( const char* p = begin; p < end; ++p) {
+                bool cur = is_digit(*p);
+                numbers += cur & !prev;
+                prev     = cur;
+        }
+        return numbers;
+}
+
+// true if [p, end) contains only whitespace
+static inline bool is_blank(const char* p, const char* end) {
+        while( p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p == end;
+}
+
+static inline const char* line_end(const char* p, const char* end) {
+        const char* nl = (const char*) memchr(p, '\n', end - p);
+        return nl == NULL ? end : nl;
+}
+
+static inline int io_num_threads() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+}
+
+static inline int io_thread_id() {
+#ifdef _OPENMP
+        return omp_get_thread_num();
+#else
+        return 0;
+#endif
+}
+
+int graph_io::readGraphWeightedParallel(graph_access & G, std::string filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        struct stat sb;
+        if (fstat(fd, &sb) < 0 || sb.st_size == 0) {
+                close(fd);
+                return readGraphWeighted(G, filename);
+        }
+
+        size_t length = sb.st_size;
+        char* data    = (char*) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+                close(fd);
+                return readGraphWeighted(G, filename);
+        }
+        madvise(data, length, MADV_WILLNEED);
+
+        const char* end = data + length;
+        const char* p   = data;
+
+        //skip comments
+        while( p < end && *p == '%' ) {
+                p = line_end(p, end) + 1;
+        }
+
+        const char* header_end = line_end(p, end);
+        long nmbNodes = parse_uint(p, header_end);
+        long nmbEdges = parse_uint(p, header_end);
+        int  ew       = parse_uint(p, header_end);
+
+        if( 2*nmbEdges > std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max()) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                exit(0);
+        }
+
+        bool read_ew = false;
+        bool read_nw = false;
+
+        if(ew == 1) {
+                read_ew = true;
+        } else if (ew == 11) {
+                read_ew = true;
+                read_nw = true;
+        } else if (ew == 10) {
+                read_nw = true;
+        }
+        nmbEdges *= 2; //since we have forward and backward edges
+
+        const char* body   = header_end < end ? header_end + 1 : end;
+        size_t body_length = end - body;
+        int num_threads    = io_num_threads();
+
+        // find the starts of all node lines (comment lines are skipped), every thread
+        // counts the line starts in its chunk of the file, a prefix sum then gives the 
+        // position to which the thread writes its line starts
+        std::vector<size_t> lines_per_chunk(num_threads+1, 0);
+        std::vector<size_t> node_lines;
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+                int t        = io_thread_id();
+                size_t begin = body_length * t / num_threads;
+                size_t stop  = body_length * (t+1) / num_threads;
+
+                size_t count = 0;
+                if( t == 0 && body_length > 0 && body[0] != '%') count++;
+                for( size_t i = begin; i < stop; i++) {
+                        count += body[i] == '\n' && i+1 < body_length && body[i+1] != '%';
+                }
+                lines_per_chunk[t+1] = count;
+
+                #pragma omp barrier
+                #pragma omp single
+                {
+                        for( int i = 0; i < num_threads; i++) {
+                                lines_per_chunk[i+1] += lines_per_chunk[i];
+                        }
+                        node_lines.resize(lines_per_chunk[num_threads]);
+                }
+
+                size_t pos = lines_per_chunk[t];
+                if( t == 0 && body_length > 0 && body[0] != '%') node_lines[pos++] = 0;
+                for( size_t i = begin; i < stop; i++) {
+                        if( body[i] == '\n' && i+1 < body_length && body[i+1] != '%') {
+                                node_lines[pos++] = i+1;
+                        }
+                }
+        }
+
+        if( node_lines.size() != (size_t) nmbNodes) {
+                std::cerr <<  "number of specified nodes mismatch"  << std::endl;
+                std::cerr <<  node_lines.size() <<  " " <<  nmbNodes  << std::endl;
+                exit(0);
+        }
+
+        // count the degrees and build the offsets via a parallel prefix sum
+        NodeID n = nmbNodes;
+        std::vector<EdgeID> offsets(n+1, 0);
+        EdgeID numbers_per_edge = read_ew ? 2 : 1;
+
+        #pragma omp parallel for schedule(dynamic, 1024) num_threads(num_threads)
+        for( long long node = 0; node < (long long) n; node++) {
+                const char* line = body + node_lines[node];
+                EdgeID numbers   = count_numbers(line, line_end(line, end));
+                if( read_nw && numbers > 0) numbers--;
+                offsets[node+1]  = numbers / numbers_per_edge;
+        }
+
+        std::vector<EdgeID> sum_per_chunk(num_threads+1, 0);
+        #pragma omp parallel num_threads(num_threads)
+        {
+                int t        = io_thread_id();
+                NodeID begin = (NodeID)((unsigned long long) n * t / num_threads) + 1;
+                NodeID stop  = (NodeID)((unsigned long long) n * (t+1) / num_threads) + 1;
+
+                for( NodeID i = begin + 1; i < stop; i++) offsets[i] += offsets[i-1];
+                sum_per_chunk[t+1] = begin < stop ? offsets[stop-1] : 0;
+
+                #pragma omp barrier
+                #pragma omp single
+                {
+                        for( int i = 0; i < num_threads; i++) {
+                                sum_per_chunk[i+1] += sum_per_chunk[i];
+                        }
+                }
+
+                for( NodeID i = begin; i < stop; i++) offsets[i] += sum_per_chunk[t];
+        }
+
+        if( offsets[n] != (EdgeID) nmbEdges ) {
+                std::cerr <<  "number of specified edges mismatch"  << std::endl;
+                std::cerr <<  offsets[n] <<  " " <<  nmbEdges  << std::endl;
+                exit(0);
+        }
+
+        G.build_from_csr_offsets(n, offsets);
+
+        // parse the node lines directly into the graph
+        long long total_nodeweight = 0;
+        EdgeID self_loops          = 0;
+
+        #pragma omp parallel for schedule(dynamic, 1024) num_threads(num_threads) reduction(+:total_nodeweight,self_loops)
+        for( long long node = 0; node < (long long) n; node++) {
+                const char* line = body + node_lines[node];
+                const char* stop = line_end(line, end);
+
+                if( read_nw ) {
+                        // an empty line keeps the default weight (as in readGraphWeighted)
+                        NodeWeight weight = 1;
+                        while( line < stop && !is_digit(*line)) ++line;
+                        if( line < stop ) weight = parse_uint(line, stop);
+                        total_nodeweight += weight;
+                        G.setNodeWeight(node, weight);
+                }
+
+                for( EdgeID e = offsets[node], e_end = offsets[node+1]; e < e_end; e++) {
+                        NodeID target = parse_uint(line, stop);
+                        self_loops   += target-1 == (NodeID) node;
+
+                        EdgeWeight edge_weight = 1;
+                        if( read_ew ) {
+                                edge_weight = parse_uint(line, stop);
+                        }
+
+                        G.setEdgeTarget(e, target-1);
+                        G.setEdgeWeight(e, edge_weight);
+                }
+        }
+
+        munmap(data, length);
+        close(fd);
+
+        if( self_loops > 0 ) {
+                std::cerr <<  "The graph file contains self-loops. This is not supported. Please remove them from the file."  << std::endl;
+        }
+
+        if( total_nodeweight > (long long) std::numeric_limits<NodeWeight>::max()) {
+                std::cerr <<  "The sum of the node weights is too large (it exceeds the node weight type)."  << std::endl;
+                std::cerr <<  "Currently not supported. Please scale your node weights."  << std::endl;
+                exit(0);
+        }
+
+        G.setUnitEdgeWeights(!read_ew);
+        return 0;
+}
+
+// binary graph format, all values in host byte order:
+//   header       : magic, version, n, m (number of directed edges), checksum, reserved (uint64 each)
+//   offsets      : (n+1) x EdgeID
+//   targets      : m x NodeID
+//   edge weights : m x EdgeWeight
+//   node weights : n x NodeWeight
+// the checksum is computed over the payload (everything after the header) as 32 bit words
+const uint64_t BINARY_GRAPH_MAGIC   = 0x4850524753554C43ULL; // "CLUSGRPH"
+const uint64_t BINARY_GRAPH_VERSION = 1;
+
+struct binary_graph_header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t n;
+        uint64_t m;
+        uint64_t checksum;
+        uint64_t reserved;
+};
+
+static inline uint64_t checksum_mix(uint64_t x) {
+        x ^= x >> 30; x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27; x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+}
+
+// order independent, hence it can be computed in parallel
+static uint64_t binary_checksum(const uint32_t* words, uint64_t count) {
+        uint64_t checksum = 0;
+        #pragma omp parallel for schedule(static) reduction(+:checksum)
+        for( long long i = 0; i < (long long) count; i++) {
+                checksum += checksum_mix((uint64_t)i * 0x9E3779B97F4A7C15ULL + words[i]);
+        }
+        return checksum;
+}
+
+static inline uint64_t binary_payload_words(uint64_t n, uint64_t m) {
+        return (n+1) + m + m + n;
+}
+
+int graph_io::writeGraphBinary(graph_access & G, std::string filename) {
+        uint64_t n = G.number_of_nodes();
+        uint64_t m = G.number_of_edges();
+
+        std::vector<uint32_t> payload(binary_payload_words(n, m));
+        uint32_t* offsets      = &payload[0];
+        uint32_t* targets      = offsets + (n+1);
+        uint32_t* edge_weights = targets + m;
+        uint32_t* node_weights = edge_weights + m;
+
+        #pragma omp parallel for schedule(static)
+        for( long long node = 0; node < (long long) n; node++) {
+                offsets[node]      = G.get_first_edge(node);
+                node_weights[node] = G.getNodeWeight(node);
+                forall_out_edges(G, e, node) {
+                        targets[e]      = G.getEdgeTarget(e);
+                        edge_weights[e] = (uint32_t) G.getEdgeWeight(e);
+                } endfor
+        }
+        offsets[n] = m;
+
+        binary_graph_header header;
+        header.magic    = BINARY_GRAPH_MAGIC;
+        header.version  = BINARY_GRAPH_VERSION;
+        header.n        = n;
+        header.m        = m;
+        header.checksum = binary_checksum(&payload[0], payload.size());
+        header.reserved = 0;
+
+        FILE* f = fopen(filename.c_str(), "wb");
+        if (f == NULL) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+        ok = ok && fwrite(&payload[0], sizeof(uint32_t), payload.size(), f) == payload.size();
+        ok = fclose(f) == 0 && ok;
+        if (!ok) {
+                std::cerr << "Error writing " << filename << std::endl;
+                return 1;
+        }
+
+        return 0;
+}
+
+int graph_io::readGraphBinaryHeader(std::string filename, NodeID & n, EdgeID & m) {
+        FILE* f = fopen(filename.c_str(), "rb");
+        if (f == NULL) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        binary_graph_header header;
+        bool ok = fread(&header, sizeof(header), 1, f) == 1;
+        fclose(f);
+
+        if (!ok || header.magic != BINARY_GRAPH_MAGIC || header.version != BINARY_GRAPH_VERSION) {
+                std::cerr << filename << " is not a binary graph file (or has an unsupported version)" << std::endl;
+                return 1;
+        }
+
+        n = header.n;
+        m = header.m;
+        return 0;
+}
+
+bool graph_io::isBinaryGraph(std::string filename) {
+        FILE* f = fopen(filename.c_str(), "rb");
+        if (f == NULL) return false;
+
+        uint64_t magic = 0;
+        bool ok = fread(&magic, sizeof(magic), 1, f) == 1;
+        fclose(f);
+
+        return ok && magic == BINARY_GRAPH_MAGIC;
+}
+
+// checks the header, the size, the checksum and the CSR structure of a mapped binary graph,
+// returns 0 if the graph can be built from it
+static int check_binary_graph(const char* data, size_t length, const std::string & filename) {
+        const binary_graph_header* header = (const binary_graph_header*) data;
+        if( header->magic != BINARY_GRAPH_MAGIC || header->version != BINARY_GRAPH_VERSION ) {
+                std::cerr << filename << " is not a binary graph file (or has an unsupported version)" << std::endl;
+                return 1;
+        }
+
+        uint64_t n = header->n;
+        uint64_t m = header->m;
+        if( m > (uint64_t) std::numeric_limits<int>::max() || n > (uint64_t) std::numeric_limits<int>::max()) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                return 1;
+        }
+
+        uint64_t words = binary_payload_words(n, m);
+        if( length != sizeof(binary_graph_header) + words * sizeof(uint32_t) ) {
+                std::cerr <<  "The size of " << filename << " does not match its header (truncated file?)"  << std::endl;
+                return 1;
+        }
+
+        const uint32_t* payload = (const uint32_t*) (data + sizeof(binary_graph_header));
+        if( binary_checksum(payload, words) != header->checksum ) {
+                std::cerr <<  "Checksum mismatch in " << filename << " (corrupted file?)"  << std::endl;
+                return 1;
+        }
+
+        // the checksum does not protect against a faulty writer
+        const uint32_t* offsets = payload;
+        const uint32_t* targets = offsets + (n+1);
+        if( offsets[0] != 0 || offsets[n] != m ) {
+                std::cerr <<  "number of specified edges mismatch"  << std::endl;
+                std::cerr <<  offsets[n] <<  " " <<  m  << std::endl;
+                return 1;
+        }
+
+        long long malformed = 0;
+        #pragma omp parallel for schedule(static) reduction(+:malformed)
+        for( long long node = 0; node < (long long) n; node++) {
+                malformed += offsets[node] > offsets[node+1];
+        }
+        #pragma omp parallel for schedule(static) reduction(+:malformed)
+        for( long long e = 0; e < (long long) m; e++) {
+                malformed += targets[e] >= n;
+        }
+        if( malformed > 0 ) {
+                std::cerr <<  filename << " has decreasing edge offsets or edge targets out of range"  << std::endl;
+                return 1;
+        }
+
+        return 0;
+}
+
+int graph_io::readGraphBinary(graph_access & G, std::string filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        struct stat sb;
+        if (fstat(fd, &sb) < 0 || (size_t) sb.st_size < sizeof(binary_graph_header)) {
+                std::cerr << filename << " is not a binary graph file" << std::endl;
+                close(fd);
+                return 1;
+        }
+
+        size_t length = sb.st_size;
+        char* data    = (char*) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+                std::cerr << "Error mapping " << filename << std::endl;
+                close(fd);
+                return 1;
+        }
+        madvise(data, length, MADV_WILLNEED);
+
+        // every failure returns 1, the reader is also used by the library interface
+        int ret_code = check_binary_graph(data, length, filename);
+        if( ret_code ) {
+                munmap(data, length);
+                close(fd);
+                return ret_code;
+        }
+
+        const binary_graph_header* header = (const binary_graph_header*) data;
+        uint64_t n = header->n;
+        uint64_t m = header->m;
+
+        const uint32_t* payload        = (const uint32_t*) (data + sizeof(binary_graph_header));
+        const EdgeID* offsets          = (const EdgeID*) payload;
+        const NodeID* targets          = (const NodeID*) (offsets + (n+1));
+        const EdgeWeight* edge_weights = (const EdgeWeight*) (targets + m);
+        const NodeWeight* node_weights = (const NodeWeight*) (edge_weights + m);
+
+        G.build_from_csr_offsets(n, offsets);
+
+        // the file always stores edge weights, the graph is marked as unweighted if they are all 1
+        EdgeID non_unit_edges = 0;
+        #pragma omp parallel for schedule(static) reduction(+:non_unit_edges)
+        for( long long node = 0; node < (long long) n; node++) {
+                G.setNodeWeight(node, node_weights[node]);
+                forall_out_edges(G, e, node) {
+                        G.setEdgeTarget(e, targets[e]);
+                        G.setEdgeWeight(e, edge_weights[e]);
+                        non_unit_edges += edge_weights[e] != 1;
+                } endfor
+        }
+        G.setUnitEdgeWeights(non_unit_edges == 0);
+
+        munmap(data, length);
+        close(fd);
+
+        return 0;
+}
+
+// edge lists, node IDs start at 0 and the number of nodes is the largest ID + 1:
+//   text   : one edge "u v [w]" per line (default weight 1), lines starting with % or # are comments
+//   binary : header (magic, version, number of edges, flags) followed by the edges as 
+//            (u, v) records of 32 bit values or, if flags & BINARY_EDGELIST_WEIGHTED, (u, v, w) records
+// every edge is undirected, i.e. it is inserted in both directions. parallel edges in the same
+// direction are merged by summing their weights, a reverse edge (v, u) is the same edge as (u, v), so
+// lists that already contain both directions (SNAP) are not doubled: the weight of {u, v} is the
+// larger of the two direction sums. a self-loop (u, u, w) ends up as m_selfLoops[u] += 2w,
+// which is the convention of the contraction (an edge contributes to the weighted degree twice)
+const uint64_t BINARY_EDGELIST_MAGIC    = 0x5453494C45474445ULL; // "EDGELIST"
+const uint64_t BINARY_EDGELIST_VERSION  = 1;
+const uint64_t BINARY_EDGELIST_WEIGHTED = 1;
+
+struct binary_edgelist_header {
+        uint64_t magic;
+        uint64_t version;
+        uint64_t m;
+        uint64_t flags;
+};
+
+struct edgelist_arc {
+        uint64_t key; // source << node_bits | target
+        EdgeWeight weight;
+};
+
+// stable LSD radix sort on the lowest key_bits bits of the keys, every pass builds
+// per thread histograms, the prefix sum over (bucket, thread) gives the scatter positions
+static void parallel_radix_sort(std::vector<edgelist_arc> & arcs, unsigned key_bits) {
+        const unsigned RADIX_BITS = 8;
+        const size_t   BUCKETS    = 1 << RADIX_BITS;
+
+        size_t size     = arcs.size();
+        int num_threads = io_num_threads();
+        std::vector<edgelist_arc> buffer(size);
+        std::vector<size_t> histogram(num_threads * BUCKETS);
+
+        for( unsigned shift = 0; shift < key_bits; shift += RADIX_BITS) {
+                #pragma omp parallel num_threads(num_threads)
+                {
+                        int t         = io_thread_id();
+                        size_t begin  = size * t / num_threads;
+                        size_t stop   = size * (t+1) / num_threads;
+                        size_t* local = &histogram[t * BUCKETS];
+
+                        std::fill(local, local + BUCKETS, 0);
+                        for( size_t i = begin; i < stop; i++) {
+                                local[(arcs[i].key >> shift) & (BUCKETS-1)]++;
+                        }
+
+                        #pragma omp barrier
+                        #pragma omp single
+                        {
+                                size_t sum = 0;
+                                for( size_t b = 0; b < BUCKETS; b++) {
+                                        for( int i = 0; i < num_threads; i++) {
+                                                size_t count = histogram[i * BUCKETS + b];
+                                                histogram[i * BUCKETS + b] = sum;
+                                                sum += count;
+                                        }
+                                }
+                        }
+
+                        for( size_t i = begin; i < stop; i++) {
+                                buffer[local[(arcs[i].key >> shift) & (BUCKETS-1)]++] = arcs[i];
+                        }
+                }
+                arcs.swap(buffer);
+        }
+}
+
+// parses the text edge list in [begin, end) in parallel, every thread parses the lines starting in its chunk
+static int parse_text_edgelist(const char* begin, const char* end, std::vector<edgelist_arc> & arcs, NodeID & max_id) {
+        size_t length   = end - begin;
+        int num_threads = io_num_threads();
+
+        std::vector< std::vector<edgelist_arc> > local_arcs(num_threads);
+        unsigned long long max_node = 0;
+        EdgeID malformed            = 0;
+
+        #pragma omp parallel num_threads(num_threads) reduction(max:max_node) reduction(+:malformed)
+        {
+                int t = io_thread_id();
+                const char* p    = begin + length * t / num_threads;
+                const char* stop = begin + length * (t+1) / num_threads;
+                // a line belongs to the thread whose chunk contains its first character
+                if( t > 0 && p[-1] != '\n' ) p = line_end(p, end) + 1;
+
+                std::vector<edgelist_arc> & local = local_arcs[t];
+                while( p < stop ) {
+                        const char* eol = line_end(p, end);
+                        while( p < eol && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+                        if( p < eol && *p != '%' && *p != '#' ) {
+                                EdgeID numbers = count_numbers(p, eol);
+                                if( numbers < 2 ) {
+                                        malformed++;
+                                } else {
+                                        unsigned long long source = parse_uint(p, eol);
+                                        unsigned long long target = parse_uint(p, eol);
+                                        EdgeWeight weight         = numbers > 2 ? parse_uint(p, eol) : 1;
+
+                                        max_node = std::max(max_node, std::max(source, target));
+
+                                        edgelist_arc arc;
+                                        arc.key    = source << 32 | target;
+                                        arc.weight = weight;
+                                        local.push_back(arc);
+                                }
+                        }
+                        p = eol + 1;
+                }
+        }
+
+        if( malformed > 0 ) {
+                std::cerr <<  malformed << " lines of the edge list contain less than two node IDs"  << std::endl;
+                return 1;
+        }
+        if( max_node >= (unsigned long long) std::numeric_limits<int>::max() ) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                exit(0);
+        }
+        max_id = max_node;
+
+        std::vector<size_t> start(num_threads+1, 0);
+        for( int i = 0; i < num_threads; i++) {
+                start[i+1] = start[i] + local_arcs[i].size();
+        }
+
+        // room for both directions, the reverse arcs are added by the caller
+        arcs.resize(2*start[num_threads]);
+        #pragma omp parallel for schedule(static, 1) num_threads(num_threads)
+        for( int i = 0; i < num_threads; i++) {
+                std::copy(local_arcs[i].begin(), local_arcs[i].end(), arcs.begin() + start[i]);
+                std::vector<edgelist_arc>().swap(local_arcs[i]);
+        }
+
+        return 0;
+}
+
+static int parse_binary_edgelist(const char* data, size_t length, std::vector<edgelist_arc> & arcs, NodeID & max_id) {
+        const binary_edgelist_header* header = (const binary_edgelist_header*) data;
+        if( header->version != BINARY_EDGELIST_VERSION ) {
+                std::cerr <<  "Unsupported version of the binary edge list"  << std::endl;
+                return 1;
+        }
+
+        uint64_t m            = header->m;
+        bool weighted         = header->flags & BINARY_EDGELIST_WEIGHTED;
+        uint64_t record_words = weighted ? 3 : 2;
+        if( length != sizeof(binary_edgelist_header) + m * record_words * sizeof(uint32_t) ) {
+                std::cerr <<  "The size of the binary edge list does not match its header (truncated file?)"  << std::endl;
+                return 1;
+        }
+
+        const uint32_t* records     = (const uint32_t*) (data + sizeof(binary_edgelist_header));
+        unsigned long long max_node = 0;
+
+        arcs.resize(2*m);
+        #pragma omp parallel for schedule(static) reduction(max:max_node)
+        for( long long i = 0; i < (long long) m; i++) {
+                const uint32_t* record = records + i * record_words;
+                uint64_t source = record[0];
+                uint64_t target = record[1];
+                max_node = std::max(max_node, (unsigned long long) std::max(source, target));
+
+                arcs[i].key    = source << 32 | target;
+                arcs[i].weight = weighted ? (EdgeWeight) record[2] : 1;
+        }
+
+        if( max_node >= (unsigned long long) std::numeric_limits<int>::max() ) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                exit(0);
+        }
+        max_id = max_node;
+
+        return 0;
+}
+
+bool graph_io::isBinaryEdgeList(std::string filename) {
+        FILE* f = fopen(filename.c_str(), "rb");
+        if (f == NULL) return false;
+
+        uint64_t magic = 0;
+        bool ok = fread(&magic, sizeof(magic), 1, f) == 1;
+        fclose(f);
+
+        return ok && magic == BINARY_EDGELIST_MAGIC;
+}
+
+int graph_io::readEdgeList(graph_access & G, std::string filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        struct stat sb;
+        if (fstat(fd, &sb) < 0 || sb.st_size == 0) {
+                std::cerr << "The edge list " << filename << " is empty" << std::endl;
+                close(fd);
+                return 1;
+        }
+
+        size_t length = sb.st_size;
+        char* data    = (char*) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+                std::cerr << "Error mapping " << filename << std::endl;
+                close(fd);
+                return 1;
+        }
+        madvise(data, length, MADV_WILLNEED);
+
+        // the first half of arcs receives the edges as they are given in the file
+        std::vector<edgelist_arc> arcs;
+        NodeID max_id = 0;
+        int ret_code  = 0;
+        if( length >= sizeof(binary_edgelist_header) && *(const uint64_t*) data == BINARY_EDGELIST_MAGIC ) {
+                ret_code = parse_binary_edgelist(data, length, arcs, max_id);
+        } else {
+                ret_code = parse_text_edgelist(data, data + length, arcs, max_id);
+        }
+
+        munmap(data, length);
+        close(fd);
+
+        if( ret_code ) return ret_code;
+        if( arcs.empty() ) {
+                std::cerr << "The edge list " << filename << " contains no edges" << std::endl;
+                return 1;
+        }
+
+        // pack the edges as (min, max) into as few bits as possible for the radix sort, the lowest bit
+        // tells whether the edge was given as (max, min)
+        NodeID n           = max_id + 1;
+        unsigned node_bits = 1;
+        while( node_bits < 32 && (max_id >> node_bits) != 0 ) node_bits++;
+
+        size_t half = arcs.size() / 2;
+        #pragma omp parallel for schedule(static)
+        for( long long i = 0; i < (long long) half; i++) {
+                uint64_t source = arcs[i].key >> 32;
+                uint64_t target = arcs[i].key & 0xFFFFFFFFULL;
+
+                arcs[i].key = (std::min(source, target) << node_bits | std::max(source, target)) << 1 | (source > target);
+        }
+
+        arcs.resize(half);
+        parallel_radix_sort(arcs, 2*node_bits+1);
+
+        // dedupe reverse duplicates: every run of an undirected edge gets the larger direction sum as weight
+        // of its first arc, the other arcs of the run get weight 0 and are merged away below
+        size_t size     = arcs.size();
+        int num_threads = io_num_threads();
+        #pragma omp parallel num_threads(num_threads)
+        {
+                int t        = io_thread_id();
+                size_t begin = size * t / num_threads;
+                size_t stop  = size * (t+1) / num_threads;
+
+                for( size_t i = begin; i < stop; i++) {
+                        if( i > 0 && arcs[i].key >> 1 == arcs[i-1].key >> 1 ) continue;
+
+                        // a run may continue in the chunk of the next thread, only its head writes the weights
+                        EdgeWeight forward = 0, backward = 0;
+                        size_t j = i;
+                        for( ; j < size && arcs[j].key >> 1 == arcs[i].key >> 1; j++) {
+                                if( arcs[j].key & 1 ) backward += arcs[j].weight;
+                                else                  forward  += arcs[j].weight;
+                                arcs[j].weight = 0;
+                        }
+                        arcs[i].weight = std::max(forward, backward);
+                }
+        }
+
+        // symmetrize
+        arcs.resize(2*half);
+        #pragma omp parallel for schedule(static)
+        for( long long i = 0; i < (long long) half; i++) {
+                uint64_t key    = arcs[i].key >> 1;
+                uint64_t source = key >> node_bits;
+                uint64_t target = key & ((1ULL << node_bits) - 1);
+
+                arcs[i].key             = key;
+                arcs[half + i].key      = target << node_bits | source;
+                arcs[half + i].weight   = arcs[i].weight;
+        }
+
+        parallel_radix_sort(arcs, 2*node_bits);
+
+        // equal keys are now consecutive, the first arc of every run (head) represents the merged edge
+        // self-loops go to m_selfLoops, all other heads are compacted into the CSR arrays
+        const uint64_t node_mask = (1ULL << node_bits) - 1;
+        size                     = arcs.size();
+
+        std::vector<size_t> heads_per_chunk(num_threads+1, 0);
+        std::vector<NodeID> sources, targets;
+        std::vector<EdgeWeight> weights;
+        std::vector<EdgeWeight> self_loops(n, 0);
+        EdgeID number_of_self_loops = 0;
+
+        #pragma omp parallel num_threads(num_threads) reduction(+:number_of_self_loops)
+        {
+                int t        = io_thread_id();
+                size_t begin = size * t / num_threads;
+                size_t stop  = size * (t+1) / num_threads;
+
+                size_t count = 0;
+                for( size_t i = begin; i < stop; i++) {
+                        bool head = i == 0 || arcs[i].key != arcs[i-1].key;
+                        count += head && (arcs[i].key >> node_bits) != (arcs[i].key & node_mask);
+                }
+                heads_per_chunk[t+1] = count;
+
+                #pragma omp barrier
+                #pragma omp single
+                {
+                        for( int i = 0; i < num_threads; i++) {
+                                heads_per_chunk[i+1] += heads_per_chunk[i];
+                        }
+                        sources.resize(heads_per_chunk[num_threads]);
+                        targets.resize(heads_per_chunk[num_threads]);
+                        weights.resize(heads_per_chunk[num_threads]);
+                }
+
+                size_t pos = heads_per_chunk[t];
+                for( size_t i = begin; i < stop; i++) {
+                        if( i > 0 && arcs[i].key == arcs[i-1].key ) continue;
+
+                        // a run may continue in the chunk of the next thread
+                        EdgeWeight weight = 0;
+                        for( size_t j = i; j < size && arcs[j].key == arcs[i].key; j++) {
+                                weight += arcs[j].weight;
+                        }
+
+                        NodeID source = arcs[i].key >> node_bits;
+                        NodeID target = arcs[i].key & node_mask;
+                        if( source == target ) {
+                                self_loops[source] = weight;
+                                number_of_self_loops++;
+                        } else {
+                                sources[pos] = source;
+                                targets[pos] = target;
+                                weights[pos] = weight;
+                                pos++;
+                        }
+                }
+        }
+        std::vector<edgelist_arc>().swap(arcs);
+
+        if( targets.size() > (size_t) std::numeric_limits<int>::max() ) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                exit(0);
+        }
+
+        // the edges are sorted by source, the first edge of a node is the first edge with a source >= node
+        EdgeID m = targets.size();
+        std::vector<EdgeID> offsets(n+1, m);
+        #pragma omp parallel for schedule(static)
+        for( long long e = 0; e < (long long) m; e++) {
+                if( e > 0 && sources[e] == sources[e-1] ) continue;
+                NodeID first = e == 0 ? 0 : sources[e-1] + 1;
+                for( NodeID node = first; node <= sources[e]; node++) {
+                        offsets[node] = e;
+                }
+        }
+
+        G.build_from_csr_offsets(n, offsets);
+
+        // merged parallel edges have weights > 1 also if the file has no weight column
+        EdgeID non_unit_edges = 0;
+        #pragma omp parallel for schedule(static) reduction(+:non_unit_edges)
+        for( long long e = 0; e < (long long) m; e++) {
+                G.setEdgeTarget(e, targets[e]);
+                G.setEdgeWeight(e, weights[e]);
+                non_unit_edges += weights[e] != 1;
+        }
+        G.setUnitEdgeWeights(non_unit_edges == 0);
+
+        if( number_of_self_loops > 0 ) {
+                G.resizeSelfLoops(n);
+                #pragma omp parallel for schedule(static)
+                for( long long node = 0; node < (long long) n; node++) {
+                        G.setSelfLoop(node, self_loops[node]);
+                }
+        }
+
+        return 0;
+}
+
+int graph_io::readGraph(graph_access & G, std::string filename) {
+        if( isBinaryGraph(filename) ) {
+                return readGraphBinary(G, filename);
+        }
+        if( isBinaryEdgeList(filename) ) {
+                return readEdgeList(G, filename);
+        }
+        return readGraphWeightedParallel(G, filename);
+}
+
+// METIS text or binary graph, every node is passed to the visitor as soon as it is parsed, hence
+// the graph is never stored in an intermediate representation
+int graph_io::readGraphStreamed(std::string filename, graph_stream_visitor & visitor) {
+        if( isBinaryEdgeList(filename) ) {
+                std::cerr << "Edge lists can not be streamed, convert " << filename << " to a METIS or binary graph" << std::endl;
+                return 1;
+        }
+
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return 1;
+        }
+
+        struct stat sb;
+        if (fstat(fd, &sb) < 0 || sb.st_size == 0) {
+                std::cerr << filename << " is empty" << std::endl;
+                close(fd);
+                return 1;
+        }
+
+        size_t length = sb.st_size;
+        char* data    = (char*) mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+                std::cerr << "Error mapping " << filename << std::endl;
+                close(fd);
+                return 1;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+
+        std::vector<std::pair<NodeID, EdgeWeight> > neighbors;
+        int ret_code = 0;
+
+        if( isBinaryGraph(filename) ) {
+                ret_code = check_binary_graph(data, length, filename);
+                if( ret_code ) {
+                        munmap(data, length);
+                        close(fd);
+                        return ret_code;
+                }
+
+                const binary_graph_header* header = (const binary_graph_header*) data;
+                uint64_t n = header->n;
+                uint64_t m = header->m;
+
+                const uint32_t* payload        = (const uint32_t*) (data + sizeof(binary_graph_header));
+                const EdgeID* offsets          = (const EdgeID*) payload;
+                const NodeID* targets          = (const NodeID*) (offsets + (n+1));
+                const EdgeWeight* edge_weights = (const EdgeWeight*) (targets + m);
+                const NodeWeight* node_weights = (const NodeWeight*) (edge_weights + m);
+
+                // the file always stores edge weights, the graph is unweighted if they are all 1
+                bool weighted = false;
+                for( uint64_t e = 0; e < m && !weighted; e++) {
+                        weighted = edge_weights[e] != 1;
+                }
+
+                visitor.start(n, m, weighted);
+                for( NodeID node = 0; node < n; node++) {
+                        neighbors.clear();
+                        for( EdgeID e = offsets[node]; e < offsets[node+1]; e++) {
+                                neighbors.push_back(std::make_pair(targets[e], edge_weights[e]));
+                        }
+                        visitor.node(neighbors, node_weights[node]);
+                }
+
+                munmap(data, length);
+                close(fd);
+                return 0;
+        }
+
+        const char* end = data + length;
+        const char* p   = data;
+
+        //skip comments
+        while( p < end && *p == '%' ) {
+                p = line_end(p, end) + 1;
+        }
+
+        const char* header_end = line_end(p, end);
+        long nmbNodes = parse_uint(p, header_end);
+        long nmbEdges = parse_uint(p, header_end);
+        int  ew       = parse_uint(p, header_end);
+
+        if( 2*nmbEdges > std::numeric_limits<int>::max() || nmbNodes > std::numeric_limits<int>::max()) {
+                std::cerr <<  "The graph is too large. Currently only 32bit supported!"  << std::endl;
+                munmap(data, length);
+                close(fd);
+                return 1;
+        }
+
+        bool read_ew = ew == 1 || ew == 11;
+        bool read_nw = ew == 10 || ew == 11;
+        nmbEdges *= 2; //since we have forward and backward edges
+
+        visitor.start(nmbNodes, nmbEdges, read_ew);
+
+        // every line that is no comment is a node, a newline at the end of the file adds no node
+        NodeID node                = 0;
+        EdgeID edges               = 0;
+        EdgeID self_loops          = 0;
+        long long total_nodeweight = 0;
+
+        p = header_end < end ? header_end + 1 : end;
+        while( p < end && ret_code == 0 ) {
+                const char* stop = line_end(p, end);
+                if( *p == '%' ) {
+                        p = stop + 1;
+                        continue;
+                }
+
+                if( node == (NodeID) nmbNodes ) {
+                        std::cerr <<  "number of specified nodes mismatch"  << std::endl;
+                        std::cerr <<  node+1 <<  " " <<  nmbNodes  << std::endl;
+                        ret_code = 1;
+                        break;
+                }
+
+                NodeWeight weight = 1;
+                if( read_nw ) {
+                        // an empty line keeps the default weight (as in readGraphWeighted)
+                        while( p < stop && !is_digit(*p)) ++p;
+                        if( p < stop ) weight = parse_uint(p, stop);
+                }
+                total_nodeweight += weight;
+
+                neighbors.clear();
+                while( !is_blank(p, stop) ) {
+                        NodeID target = parse_uint(p, stop);
+                        EdgeWeight edge_weight = 1;
+                        if( read_ew ) {
+                                edge_weight = parse_uint(p, stop);
+                        }
+
+                        if( target == 0 || target > (NodeID) nmbNodes ) {
+                                std::cerr <<  "Node " << node+1 << " has the edge target " << target << " which is out of range"  << std::endl;
+                                ret_code = 1;
+                                break;
+                        }
+                        self_loops += target-1 == node;
+                        neighbors.push_back(std::make_pair(target-1, edge_weight));
+                }
+
+                if( ret_code == 0 ) {
+                        edges += neighbors.size();
+                        visitor.node(neighbors, weight);
+                        node++;
+                }
+                p = stop + 1;
+        }
+
+        munmap(data, length);
+        close(fd);
+
+        if( ret_code ) {
+                return ret_code;
+        }
+
+        if( node != (NodeID) nmbNodes ) {
+                std::cerr <<  "number of specified nodes mismatch"  << std::endl;
+                std::cerr <<  node <<  " " <<  nmbNodes  << std::endl;
+                return 1;
+        }
+
+        if( edges != (EdgeID) nmbEdges ) {
+                std::cerr <<  "number of specified edges mismatch"  << std::endl;
+                std::cerr <<  edges <<  " " <<  nmbEdges  << std::endl;
+                return 1;
+        }
+
+        if( self_loops > 0 ) {
+                std::cerr <<  "The graph file contains self-loops. This is not supported. Please remove them from the file."  << std::endl;
+        }
+
+        if( total_nodeweight > (long long) std::numeric_limits<NodeWeight>::max()) {
+                std::cerr <<  "The sum of the node weights is too large (it exceeds the node weight type)."  << std::endl;
+                std::cerr <<  "Currently not supported. Please scale your node weights."  << std::endl;
+                return 1;
+        }
+
+        return 0;
+}
+
+const uint64_t BINARY_PARTITION_MAGIC   = 0x54524150534C4356ULL; // "VCLSPART"
+const uint64_t BINARY_PARTITION_VERSION = 1;
+
+int graph_io::readPartition(std::string filename, NodeID n, std::vector<PartitionID> & partition) {
+        FILE* f = fopen(filename.c_str(), "rb");
+        if (f == NULL) {
+                std::cerr << "Error opening file " << filename << std::endl;
+                return 1;
+        }
+
+        fseek(f, 0, SEEK_END);
+        size_t length = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        std::vector<char> buffer(length);
+        bool ok = length == 0 || fread(&buffer[0], 1, length, f) == length;
+        fclose(f);
+        if (!ok) {
+                std::cerr << "Error reading " << filename << std::endl;
+                return 1;
+        }
+
+        partition.assign(n, 0);
+
+        uint64_t header[3];
+        if( length >= sizeof(header) ) {
+                memcpy(header, &buffer[0], sizeof(header));
+        }
+        if( length >= sizeof(header) && header[0] == BINARY_PARTITION_MAGIC ) {
+                if( header[1] != BINARY_PARTITION_VERSION || header[2] != n 
+                 || length != sizeof(header) + n * sizeof(uint32_t)) {
+                        std::cerr << "The binary partition " << filename << " does not match the graph" << std::endl;
+                        return 1;
+                }
+                if( n > 0 ) memcpy(&partition[0], &buffer[sizeof(header)], n * sizeof(uint32_t));
+                return 0;
+        }
+
+        // text format, one block ID per line, lines starting with % and empty lines are skipped
+        const char* p   = buffer.empty() ? NULL : &buffer[0];
+        const char* end = p + length;
+        NodeID node     = 0;
+        while( p < end ) {
+                const char* stop = line_end(p, end);
+                if( *p != '%' && !is_blank(p, stop) ) {
+                        if( node == n ) {
+                                std::cerr << "The partition " << filename << " has more than " << n << " entries" << std::endl;
+                                return 1;
+                        }
+                        partition[node++] = parse_uint(p, stop);
+                }
+                p = stop + 1;
+        }
+
+        if( node < n ) {
+                std::cerr << "The partition " << filename << " has " << node << " entries, the graph has " << n << " nodes" << std::endl;
+                return 1;
+        }
+
+        return 0;
+}
+
 void graph_io::writePartition(graph_access & G, std::string filename) {
-        std::ofstream f(filename.c_str());
+        std::vector<PartitionID> partition(G.number_of_nodes());
+        forall_nodes(G, node) {
+                partition[node] = G.getPartitionIndex(node);
+        } endfor
+
+        writePartition(partition, filename);
+}
+
+void graph_io::writePartition(const std::vector<PartitionID> & partition, std::string filename) {
         std::cout << "writing partition to " << filename << " ... " << std::endl;
 
+        // format the IDs into a single buffer and write it at once
+        std::vector<char> buffer;
+        buffer.reserve(partition.size() * 4);
+
+        char digits[16];
+        for( size_t node = 0; node < partition.size(); node++) {
+                PartitionID block = partition[node];
+                int len = 0;
+                do {
+                        digits[len++] = '0' + block % 10;
+                        block /= 10;
+                } while( block > 0 );
+
+                while( len > 0 ) buffer.push_back(digits[--len]);
+                buffer.push_back('\n');
+        }
+
+        FILE* f = fopen(filename.c_str(), "wb");
+        if (f == NULL) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return;
+        }
+        if( !buffer.empty() ) fwrite(&buffer[0], 1, buffer.size(), f);
+        fclose(f);
+}
+
+void graph_io::writePartitionBinary(graph_access & G, std::string filename) {
+        std::vector<PartitionID> partition(G.number_of_nodes());
         forall_nodes(G, node) {
-                f << G.getPartitionIndex(node) <<  std::endl;
+                partition[node] = G.getPartitionIndex(node);
         } endfor
 
-        f.close();
+        writePartitionBinary(partition, filename);
 }
 
+void graph_io::writePartitionBinary(const std::vector<PartitionID> & partition, std::string filename) {
+        std::cout << "writing binary partition to " << filename << " ... " << std::endl;
+
+        uint64_t header[3] = { BINARY_PARTITION_MAGIC, BINARY_PARTITION_VERSION, partition.size() };
 
+        FILE* f = fopen(filename.c_str(), "wb");
+        if (f == NULL) {
+                std::cerr << "Error opening " << filename << std::endl;
+                return;
+        }
+        fwrite(header, sizeof(uint64_t), 3, f);
+        if( !partition.empty() ) fwrite(&partition[0], sizeof(uint32_t), partition.size(), f);
+        fclose(f);
+}
@@ -12,13 +12,27 @@
 #include <iostream>
 #include <limits>
 #include <ostream>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <utility>
 #include <vector>
 
 #include "definitions.h"
 #include "data_structure/graph_access.h"
 
+// receives the nodes of graph_io::readGraphStreamed() in increasing order
+class graph_stream_visitor {
+        public:
+                virtual ~graph_stream_visitor() {}
+
+                // n nodes and m directed edges, weighted is false if all edge weights are 1
+                virtual void start(NodeID n, EdgeID m, bool weighted) = 0;
+
+                // the next node with its (target, edge weight) pairs, they may be changed by the visitor
+                virtual void node(std::vector<std::pair<NodeID, EdgeWeight> > & neighbors, NodeWeight weight) = 0;
+};
+
 class graph_io {
         public:
                 graph_io();
@@ -31,6 +45,27 @@ class graph_io {
                 static int naive(const std::string& str, size_t & line_ptr);
                 static int readGraphWeightedFast(graph_access & G, std::string filename);
 
+                // memory maps the file and parses it in parallel (same validation as readGraphWeighted)
+                static int readGraphWeightedParallel(graph_access & G, std::string filename);
+
+                // binary CSR format (see graph_io.cpp), mapped into memory and checksummed on load
+                static int readGraphBinary(graph_access & G, std::string filename);
+                static int writeGraphBinary(graph_access & G, std::string filename);
+                static int readGraphBinaryHeader(std::string filename, NodeID & n, EdgeID & m);
+                static bool isBinaryGraph(std::string filename);
+
+                // edge lists in text or binary format (see graph_io.cpp), symmetrized, parallel edges
+                // are merged by summing their weights, reverse duplicates (v, u) of (u, v) are the same
+                // edge and self-loops are moved into the self-loop weights
+                static int readEdgeList(graph_access & G, std::string filename);
+                static bool isBinaryEdgeList(std::string filename);
+
+                // reads a graph in METIS, binary or binary edge list format (detected by the magic number)
+                static int readGraph(graph_access & G, std::string filename);
+
+                // passes a graph in METIS or binary format node by node to the visitor (no edge lists)
+                static int readGraphStreamed(std::string filename, graph_stream_visitor & visitor);
+
                 static
                 int writeGraphWeighted(graph_access & G, std::string filename);
 
@@ -40,9 +75,23 @@ class graph_io {
                 static
                 int readPartition(graph_access& G, std::string filename);
 
+                // reads a partition in text or binary format (detected by the magic number) without touching a graph
+                static
+                int readPartition(std::string filename, NodeID n, std::vector<PartitionID> & partition);
+
                 static
                 void writePartition(graph_access& G, std::string filename);
 
+                static
+                void writePartition(const std::vector<PartitionID> & partition, std::string filename);
+
+                // binary partition format: header (magic, version, n) followed by n block IDs
+                static
+                void writePartitionBinary(graph_access& G, std::string filename);
+
+                static
+                void writePartitionBinary(const std::vector<PartitionID> & partition, std::string filename);
+
                 template<typename vectortype>
                 static void writeVector(std::vector<vectortype> & vec, std::string filename);
 
@@ -413,6 +413,43 @@ struct PartitionConfig
           For the size constrained label propagation we set the maximum size
           of a cluster to (number_of_nodes / lm_cluster_coarsening_factor). */
         unsigned lm_cluster_coarsening_factor;
+        /** Renumbering of the nodes of the input graph and of each coarse
+          graph in the Louvain method to improve the memory locality
+          (none, degree, BFS, reverse Cuthill-McKee or cluster contiguous). */
+        NodeReorderingType lm_node_reordering;
+        /** If non-zero, the local move phases visit the nodes in a block randomized
+          order: blocks of about this many out edges in random order, the nodes of
+          a block in random order. Zero means a random permutation of all nodes. */
+        unsigned lm_visit_block_edges;
+        /** Objective of the Louvain local moves: modularity or the constant Potts model. */
+        ClusteringObjectiveType lm_objective;
+        /** Resolution parameter gamma of the objective (1 is plain modularity). */
+        double lm_resolution;
+        /** If TRUE, the local moves compare the modularity gains as integers
+          (exact and independent of the instruction set). Only for plain modularity. */
+        bool lm_exact_gains;
+        /** Nodes with more out edges are heavy: label propagation, the local moves and
+          the contraction aggregate their edges in parallel chunks (same result).
+          Zero disables it. */
+        NodeID lm_heavy_node_degree;
+        /** If non-zero, heavy nodes rate only a sample of about this many edges in the
+          first label propagation iteration and local move sweep of each level (not exact). */
+        NodeID lm_heavy_node_sample;
+        /** A Louvain level whose number of nodes divided by its number of clusters is
+          smaller shrinks too little (values <= 1 disable the check). */
+        double lm_minimum_shrink_factor;
+        /** What to do on such a level: stop coarsening, or aggregate with label propagation
+          (size constrained if lm_cluster_coarsening_factor > 0) and stop if that also
+          shrinks too little or lowers the objective. */
+        LowShrinkActionType lm_low_shrink_action;
+        /** If TRUE, each level of the uncoarsening (and of the multilevel combine) is also
+          refined by FM: boundary nodes move in the order of their gains (also negative ones),
+          then the moves after the best quality are undone. */
+        bool lm_fm_refinement;
+        /** Maximum number of FM rounds per level (stops earlier without improvement). */
+        unsigned lm_fm_rounds;
+        /** An FM round stops after this many moves without improvement. */
+        NodeID lm_fm_search_depth;
         /** File name for JSON output of log. */
         std::string outputLogJsonFileName;
         int do_additional_ls;
@@ -429,6 +466,46 @@ struct PartitionConfig
 
         double mh_mutate_fraction;
 
+        /** Split the clusters of a mutation by BFS and label propagation instead of KaFFPa. */
+        bool mh_mutate_light_split;
+
+        /** Probability that the partitioning combine reuses a cached partition, 0 disables the cache. */
+        double mh_partition_cache_reuse;
+
+        /** All input partitions given to the evaluator. */
+        std::vector<std::string> input_partitions;
+        /** Write the final clustering in the binary partition format. */
+        bool binary_partition_output;
+        /** The input graph is an edge list (text or binary) instead of a METIS graph. */
+        bool input_edge_list;
+        /** Read the graph into a CompressedGraph and cluster it by the Louvain method
+          instead of the evolutionary algorithm. */
+        bool compressed_graph;
+        /** Fold unit pendant vertices before the evolutionary algorithm and lift the
+          clustering back afterwards (see GraphReduction). */
+        bool reduce_graph;
+        /** Heuristic: also fold dangling chains and trees, implies reduce_graph. */
+        bool reduce_graph_trees;
+        /** Heuristic: also merge structurally identical twins, implies reduce_graph. */
+        bool reduce_graph_twins;
+        /** Cluster the connected components independently (see component_clustering). */
+        bool split_components;
+        /** Number of label propagation and contraction levels before the evolutionary
+          algorithm, 0 runs it on the input graph (see multilevel_mh_clustering). */
+        unsigned mh_coarsening_levels;
+        /** The coarsening stops at this many nodes, it also bounds the cluster weight of the
+          size constrained label propagation to the total weight divided by it. */
+        NodeID mh_coarsening_minimum_nodes;
+        /** Contract the graph of the evolutionary algorithm by the consensus of the pool
+          every this many rounds, 0 disables it. */
+        unsigned mh_consensus_interval;
+        /** Reproducible evolutionary algorithm: mh_deterministic_rounds rounds instead of the
+          time limit and a pool of mh_pool_size individuals (not estimated from the running
+          time). With several PEs the exchanges still depend on the timing. */
+        bool mh_deterministic;
+        /** Number of rounds of the evolutionary algorithm in deterministic mode. */
+        unsigned mh_deterministic_rounds;
+
 };
 
 
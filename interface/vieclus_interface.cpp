@@ -9,6 +9,7 @@
 
 #include "vieclus_interface.h"
 #include "data_structure/graph_access.h"
+#include "graph_io.h"
 #include "tools/random_functions.h"
 #include "tools/modularitymetric.h"
 #include "tools/global_timer.h"
@@ -48,15 +49,10 @@ static void internal_build_graph(int* n,
         }
 }
 
-void vieclus_clustering(int* n, int* vwgt, int* xadj,
-                        int* adjcwgt, int* adjncy,
-                        bool suppress_output, int seed,
-                        double time_limit, int cluster_upperbound,
-                        double* modularity, int* num_clusters, int* clustering) {
-
-        int argn_dummy = 0;
-        char** argv_dummy = NULL;
-        MPI_Init(&argn_dummy, &argv_dummy);
+static void internal_clustering(graph_access & G,
+                                bool suppress_output, int seed,
+                                double time_limit, int cluster_upperbound,
+                                double* modularity, int* num_clusters, int* clustering) {
 
 #ifdef _OPENMP
         omp_set_num_threads(1);
@@ -80,9 +76,6 @@ void vieclus_clustering(int* n, int* vwgt, int* xadj,
                 config.upper_bound_partition = std::numeric_limits<NodeWeight>::max() / 2;
         }
 
-        // Build graph
-        graph_access G;
-        internal_build_graph(n, vwgt, xadj, adjcwgt, adjncy, G);
         G.set_partition_count(1);
 
         srand(seed);
@@ -101,6 +94,58 @@ void vieclus_clustering(int* n, int* vwgt, int* xadj,
         forall_nodes(G, node) {
                 clustering[node] = G.getPartitionIndex(node);
         } endfor
+}
+
+void vieclus_clustering(int* n, int* vwgt, int* xadj,
+                        int* adjcwgt, int* adjncy,
+                        bool suppress_output, int seed,
+                        double time_limit, int cluster_upperbound,
+                        double* modularity, int* num_clusters, int* clustering) {
+
+        int argn_dummy = 0;
+        char** argv_dummy = NULL;
+        MPI_Init(&argn_dummy, &argv_dummy);
+
+        // Build graph
+        graph_access G;
+        internal_build_graph(n, vwgt, xadj, adjcwgt, adjncy, G);
+
+        internal_clustering(G, suppress_output, seed, time_limit, cluster_upperbound,
+                            modularity, num_clusters, clustering);
+
+        MPI_Finalize();
+}
+
+int vieclus_binary_graph_size(const char* filename, int* n, int* m) {
+        NodeID nodes = 0;
+        EdgeID edges = 0;
+        if (graph_io::readGraphBinaryHeader(filename, nodes, edges)) {
+                return 1;
+        }
+
+        *n = nodes;
+        *m = edges;
+        return 0;
+}
+
+int vieclus_clustering_binary(const char* filename,
+                              bool suppress_output, int seed,
+                              double time_limit, int cluster_upperbound,
+                              double* modularity, int* num_clusters, int* clustering) {
+
+        // Load graph (memory mapped, without parsing)
+        graph_access G;
+        if (graph_io::readGraphBinary(G, filename)) {
+                return 1;
+        }
+
+        int argn_dummy = 0;
+        char** argv_dummy = NULL;
+        MPI_Init(&argn_dummy, &argv_dummy);
+
+        internal_clustering(G, suppress_output, seed, time_limit, cluster_upperbound,
+                            modularity, num_clusters, clustering);
 
         MPI_Finalize();
+        return 0;
 }
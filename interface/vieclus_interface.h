@@ -36,6 +36,20 @@ void vieclus_clustering(int* n, int* vwgt, int* xadj,
                         double time_limit, int cluster_upperbound,
                         double* modularity, int* num_clusters, int* clustering);
 
+// Graph clustering of a graph stored in the binary graph format (see graph2binary).
+// The file is memory mapped and loaded without parsing, all other parameters
+// and the outputs are the same as for vieclus_clustering.
+// clustering must have room for n entries (see vieclus_binary_graph_size).
+// Returns 0 on success.
+int vieclus_clustering_binary(const char* filename,
+                              bool suppress_output, int seed,
+                              double time_limit, int cluster_upperbound,
+                              double* modularity, int* num_clusters, int* clustering);
+
+// Reads the number of nodes n and the number of (directed) edges m from the
+// header of a binary graph file. Returns 0 on success.
+int vieclus_binary_graph_size(const char* filename, int* n, int* m);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,8 @@
 
 #include "contractor.h"
 
+#include "clustering/heavynodes.h"
+
 using namespace std;
 
 Contractor::Contractor()
@@ -121,3 +123,162 @@ void Contractor::contractClustering(const PartitionConfig &config,
     // resize to actual number of nodes
     coarser.finish_construction();
 }
+
+
+PartitionID Contractor::contractClustering(const ClusteringGraph &finer,
+                                           vector<PartitionID> &clustering,
+                                           ClusteringGraph &coarser,
+                                           NodeID heavyNodeDegree)
+{
+    return contract(finer, clustering, coarser, heavyNodeDegree, finer.number_of_edges());
+}
+
+
+PartitionID Contractor::contractClustering(const CompressedGraph &finer,
+                                           vector<PartitionID> &clustering,
+                                           ClusteringGraph &coarser,
+                                           NodeID heavyNodeDegree)
+{
+    // the upper bound of the ClusteringGraph would be as large as the uncompressed
+    // input, the coarse edges are appended without it
+    return contract(finer, clustering, coarser, heavyNodeDegree, 0);
+}
+
+
+template <typename Graph>
+PartitionID Contractor::contract(const Graph &finer,
+                                 vector<PartitionID> &clustering,
+                                 ClusteringGraph &coarser,
+                                 NodeID heavyNodeDegree,
+                                 EdgeID edgesToReserve)
+{
+    NodeID n = finer.number_of_nodes();
+    // new consecutive cluster IDs in order of first occurrence,
+    // the old IDs are smaller than the number of nodes
+    vector<PartitionID> clusterIDLookUp(n, UNDEFINED_NODE);
+    PartitionID numberOfClusters = 0;
+
+    forall_nodes(finer, node)
+    {
+        PartitionID &newCluster = clusterIDLookUp[clustering[node]];
+
+        if (newCluster == UNDEFINED_NODE)
+        {
+            newCluster = numberOfClusters++;
+        }
+        clustering[node] = newCluster;
+    } endfor
+
+    if (finer.hasUnitEdgeWeights())
+    {
+        buildCoarseGraph<true>(finer, clustering, numberOfClusters, coarser, heavyNodeDegree, edgesToReserve);
+    }
+    else
+    {
+        buildCoarseGraph<false>(finer, clustering, numberOfClusters, coarser, heavyNodeDegree, edgesToReserve);
+    }
+
+    return numberOfClusters;
+}
+
+
+template <bool UnitEdgeWeights, typename Graph>
+void Contractor::buildCoarseGraph(const Graph &finer,
+                                  const vector<PartitionID> &clustering,
+                                  PartitionID numberOfClusters,
+                                  ClusteringGraph &coarser,
+                                  NodeID heavyNodeDegree,
+                                  EdgeID edgesToReserve)
+{
+    NodeID n = finer.number_of_nodes();
+
+    // reverse mapping "cluster c consists of nodes...", in increasing node order
+    vector<NodeID> clusterStart(numberOfClusters + 1, 0);
+    vector<NodeID> clusterNodes(n);
+
+    forall_nodes(finer, node)
+    {
+        clusterStart[clustering[node] + 1]++;
+    } endfor
+
+    for (PartitionID cluster = 0; cluster < numberOfClusters; ++cluster)
+    {
+        clusterStart[cluster + 1] += clusterStart[cluster];
+    }
+
+    {
+        vector<NodeID> position(clusterStart.begin(), clusterStart.end() - 1);
+        forall_nodes(finer, node)
+        {
+            clusterNodes[position[clustering[node]]++] = node;
+        } endfor
+    }
+
+    // look-up table for the edges of the current cluster (see above)
+    vector<pair<PartitionID, EdgeID> > edgeLookUp(numberOfClusters, make_pair(UNDEFINED_NODE, UNDEFINED_EDGE));
+    // fine nodes of high degree are aggregated by target cluster first
+    HeavyNodeAggregation heavyNodes;
+
+    heavyNodes.initialize(heavyNodeDegree, 0);
+    coarser.startConstruction(numberOfClusters, edgesToReserve);
+
+    for (PartitionID cluster = 0; cluster < numberOfClusters; ++cluster)
+    {
+        EdgeWeight weightOfSelfLoop = 0;
+        NodeWeight coarserNodeWeight = 0;
+
+        // adds the weight of out edges of the current cluster to "targetClusterInCoarseGraph"
+        auto addEdgeWeight = [&](PartitionID targetClusterInCoarseGraph, EdgeWeight weightOfCurrentOutEdge)
+        {
+            // edge inside cluster becomes a self loop
+            if (targetClusterInCoarseGraph == cluster)
+            {
+                weightOfSelfLoop += weightOfCurrentOutEdge;
+            }
+            else if (edgeLookUp[targetClusterInCoarseGraph].first == cluster)
+            {
+                // update the existing edge in the coarse graph
+                EdgeID edgeInCoarseGraph = edgeLookUp[targetClusterInCoarseGraph].second;
+                coarser.setEdgeWeight(edgeInCoarseGraph, coarser.getEdgeWeight<false>(edgeInCoarseGraph) + weightOfCurrentOutEdge);
+            }
+            else
+            {
+                // insert a new edge in the coarse graph
+                edgeLookUp[targetClusterInCoarseGraph].first = cluster;
+                edgeLookUp[targetClusterInCoarseGraph].second = coarser.newEdge(targetClusterInCoarseGraph, weightOfCurrentOutEdge);
+            }
+        };
+
+        for (NodeID i = clusterStart[cluster]; i < clusterStart[cluster + 1]; ++i)
+        {
+            NodeID finerNode = clusterNodes[i];
+
+            coarserNodeWeight += finer.getNodeWeight(finerNode);
+            weightOfSelfLoop += finer.getSelfLoop(finerNode);
+
+            // the aggregated target clusters are in the order of their first edge,
+            // so the coarse edges are the same
+            if (heavyNodes.isHeavy(finer, finerNode))
+            {
+                NodeID count = heavyNodes.aggregate<UnitEdgeWeights>(finer, finerNode, clustering);
+                const PartitionID *targetClusters = heavyNodes.getClusters();
+                const EdgeWeight *edgeWeights = heavyNodes.getEdgeWeights();
+
+                for (NodeID j = 0; j < count; ++j)
+                {
+                    addEdgeWeight(targetClusters[j], edgeWeights[j]);
+                }
+                continue;
+            }
+
+            forall_neighbors(finer, finerNode, target, weight, UnitEdgeWeights)
+            {
+                addEdgeWeight(clustering[target], weight);
+            } endfor
+        }
+
+        coarser.finishNode(coarserNodeWeight, weightOfSelfLoop);
+    }
+
+    coarser.finishConstruction();
+}
@@ -9,6 +9,8 @@
 #define CONTRACTOR_H
 
 
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include "partition/partition_config.h"
 
@@ -42,7 +44,61 @@ class Contractor
                                        const CoarseMapping &coarseMapping,
                                        const std::vector<std::vector<NodeID> > &reverseCoarseMapping);
 
+
+        /**
+         *  \brief Transforms the clustering of a fine ClusteringGraph to a coarser graph.
+         *
+         *  Same as above (also the order of the coarse nodes and edges), but the
+         *  mappings are computed here.
+         *
+         *  \param finer Fine graph which clusters are then nodes in the coarse graph.
+         *  \param clustering [in/out] Cluster of each node in the fine graph, renumbered
+         *  to the consecutive range [0, clusterCount-1] in order of first occurrence
+         *  (as Coarsening does). Afterwards this is the coarse mapping.
+         *  \param coarser [out] Coarse graph, contains self loops.
+         *  \param heavyNodeDegree The out edges of fine nodes with a higher degree are
+         *  aggregated in parallel chunks (see HeavyNodeAggregation), 0 disables it.
+         *  The coarse graph is the same.
+         *
+         *  \return Number of clusters (nodes of the coarse graph).
+         */
+        static PartitionID contractClustering(const ClusteringGraph &finer,
+                                              std::vector<PartitionID> &clustering,
+                                              ClusteringGraph &coarser,
+                                              NodeID heavyNodeDegree = 0);
+
+        /**
+         *  \brief Same as above for a CompressedGraph, the coarse graph is a ClusteringGraph.
+         */
+        static PartitionID contractClustering(const CompressedGraph &finer,
+                                              std::vector<PartitionID> &clustering,
+                                              ClusteringGraph &coarser,
+                                              NodeID heavyNodeDegree = 0);
+
     protected:
+        /**
+         *  \brief contractClustering() for a ClusteringGraph or CompressedGraph.
+         *
+         *  \param edgesToReserve Number of coarse edges reserved in advance.
+         */
+        template <typename Graph>
+        static PartitionID contract(const Graph &finer,
+                                    std::vector<PartitionID> &clustering,
+                                    ClusteringGraph &coarser,
+                                    NodeID heavyNodeDegree,
+                                    EdgeID edgesToReserve);
+
+        /**
+         *  \brief Builds the coarse graph of contractClustering() from the consecutive clustering,
+         *  instantiated for a finer graph with unit or weighted edges (the coarse graph is weighted).
+         */
+        template <bool UnitEdgeWeights, typename Graph>
+        static void buildCoarseGraph(const Graph &finer,
+                                     const std::vector<PartitionID> &clustering,
+                                     PartitionID numberOfClusters,
+                                     ClusteringGraph &coarser,
+                                     NodeID heavyNodeDegree,
+                                     EdgeID edgesToReserve);
 
     private:
 };
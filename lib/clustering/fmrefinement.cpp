@@ -0,0 +1,242 @@
+/******************************************************************************
+ * fmrefinement.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "fmrefinement.h"
+
+#include "tools/random_functions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+
+FMRefinement::FMRefinement()
+    : m_gainScale(1.0)
+{
+    //ctor
+}
+
+
+FMRefinement::~FMRefinement()
+{
+    //dtor
+}
+
+
+template <typename Objective>
+NodeID FMRefinement::refine(const PartitionConfig &config, const ClusteringGraph &G,
+                            vector<PartitionID> &clustering, ObjectiveMetric<Objective> &objective)
+{
+    /// number of node moves that were kept
+    NodeID numberOfMoves = 0;
+    EdgeWeight maximumVolume = 1;
+
+    // the gains are exact, heavy nodes are aggregated in parallel but not sampled
+    m_neighborhood.initialize(&G, &clustering);
+    m_neighborhood.initializeHeavyNodes(config.lm_heavy_node_degree, 0);
+    m_moved.assign(G.number_of_nodes(), false);
+
+    // the modularity gains are at most about twice the maximum volume,
+    // so the keys keep a safety margin to the integer range
+    forall_nodes(G, node)
+    {
+        maximumVolume = max(maximumVolume, G.getWeightedNodeDegree(node) + G.getSelfLoop(node));
+    } endfor
+    m_gainScale = numeric_limits<Gain>::max() / 4 / static_cast<double>(maximumVolume);
+
+    for (unsigned round = 0; round < config.lm_fm_rounds; ++round)
+    {
+        NodeID movesOfRound = G.hasUnitNodeWeights()
+                              ? performRound<Objective, true>(config, G, clustering, objective)
+                              : performRound<Objective, false>(config, G, clustering, objective);
+
+        if (!movesOfRound)
+        {
+            break;
+        }
+        numberOfMoves += movesOfRound;
+    }
+
+    return numberOfMoves;
+}
+
+
+template <typename Objective, bool UnitNodeWeights>
+NodeID FMRefinement::performRound(const PartitionConfig &config, const ClusteringGraph &G,
+                                  vector<PartitionID> &clustering, ObjectiveMetric<Objective> &objective)
+{
+    /// boundary nodes by the gain of their best move
+    maxNodeHeap queue;
+    /// random order to insert the nodes, the heap breaks ties by it
+    vector<NodeID> permutation(G.number_of_nodes());
+    /// TRUE, if graph has self loops
+    bool hasGraphSelfLoops = G.containsSelfLoops();
+    double bestQuality = objective.quality();
+    /// number of moves up to the best quality
+    NodeID bestPrefix = 0;
+    NodeID movesWithoutImprovement = 0;
+    PartitionID target = 0;
+    double gain = 0.0;
+
+    m_movedNodes.clear();
+    m_previousClusters.clear();
+
+    random_functions::permutate_vector_good(permutation, true);
+
+    forall_nodes(G, nn)
+    {
+        NodeID node = permutation[nn];
+
+        if (computeBestMove<Objective, UnitNodeWeights>(node, clustering, objective, target, gain))
+        {
+            queue.insert(node, toKey(gain));
+        }
+    } endfor
+
+    while (!queue.empty() && movesWithoutImprovement < config.lm_fm_search_depth)
+    {
+        NodeID node = queue.deleteMax();
+
+        // the key may be outdated (the volumes of the clusters change), so the
+        // move is computed again, it is done also if the gain is negative
+        if (!computeBestMove<Objective, UnitNodeWeights>(node, clustering, objective, target, gain))
+        {
+            continue;
+        }
+
+        PartitionID oldCluster = clustering[node];
+        EdgeWeight nodeVolume = objective.template nodeVolume<UnitNodeWeights>(node);
+        EdgeWeight selfLoop = hasGraphSelfLoops ? G.getSelfLoop(node) : 0;
+
+        objective.removeNode(node, nodeVolume, oldCluster, m_neighborhood.getEdgeWeightToNeighbor(0), selfLoop);
+        objective.insertNode(node, nodeVolume, target, m_neighborhood.getEdgeWeightToNeighboringCluster(target), selfLoop);
+
+        m_moved[node] = true;
+        m_movedNodes.push_back(node);
+        m_previousClusters.push_back(oldCluster);
+
+        if (objective.quality() > bestQuality)
+        {
+            bestQuality = objective.quality();
+            bestPrefix = m_movedNodes.size();
+            movesWithoutImprovement = 0;
+        }
+        else
+        {
+            movesWithoutImprovement++;
+        }
+
+        // the gains of the neighbors changed, they may also be new boundary nodes
+        forall_out_edges(G, e, node)
+        {
+            NodeID neighbor = G.getEdgeTarget(e);
+
+            if (m_moved[neighbor])
+            {
+                continue;
+            }
+
+            if (computeBestMove<Objective, UnitNodeWeights>(neighbor, clustering, objective, target, gain))
+            {
+                if (queue.contains(neighbor))
+                {
+                    queue.changeKey(neighbor, toKey(gain));
+                }
+                else
+                {
+                    queue.insert(neighbor, toKey(gain));
+                }
+            }
+            else if (queue.contains(neighbor))
+            {
+                queue.deleteNode(neighbor);
+            }
+        } endfor
+    }
+
+    // roll back to the best quality, in reverse order of the moves
+    for (NodeID i = m_movedNodes.size(); i > bestPrefix; --i)
+    {
+        NodeID node = m_movedNodes[i - 1];
+        PartitionID previousCluster = m_previousClusters[i - 1];
+        PartitionID currentCluster = clustering[node];
+        EdgeWeight nodeVolume = objective.template nodeVolume<UnitNodeWeights>(node);
+        EdgeWeight selfLoop = hasGraphSelfLoops ? G.getSelfLoop(node) : 0;
+        EdgeWeight edgeWeightToCurrentCluster = m_neighborhood.computeEdgeWeightToCluster(node, currentCluster);
+        EdgeWeight edgeWeightToPreviousCluster = m_neighborhood.computeEdgeWeightToCluster(node, previousCluster);
+
+        objective.removeNode(node, nodeVolume, currentCluster, edgeWeightToCurrentCluster, selfLoop);
+        objective.insertNode(node, nodeVolume, previousCluster, edgeWeightToPreviousCluster, selfLoop);
+    }
+
+    for (NodeID i = 0, size = m_movedNodes.size(); i < size; ++i)
+    {
+        m_moved[m_movedNodes[i]] = false;
+    }
+
+    return bestPrefix;
+}
+
+
+template <typename Objective, bool UnitNodeWeights>
+bool FMRefinement::computeBestMove(NodeID node, const vector<PartitionID> &clustering,
+                                   const ObjectiveMetric<Objective> &objective,
+                                   PartitionID &target, double &gain)
+{
+    m_neighborhood.update(node);
+
+    NodeID count = m_neighborhood.getNumberOfNeighboringClusters();
+
+    // the own cluster is the first one
+    if (count <= 1)
+    {
+        return false;
+    }
+
+    EdgeWeight nodeVolume = objective.template nodeVolume<UnitNodeWeights>(node);
+    double bestGain = -numeric_limits<double>::max();
+
+    for (NodeID i = 1; i < count; ++i)
+    {
+        PartitionID cluster = m_neighborhood.getClusterIDOfNeighbor(i);
+        double clusterGain = objective.gain(nodeVolume, cluster, m_neighborhood.getEdgeWeightToNeighbor(i));
+
+        if (bestGain < clusterGain)
+        {
+            bestGain = clusterGain;
+            target = cluster;
+        }
+    }
+
+    gain = bestGain - objective.gainInOwnCluster(nodeVolume, clustering[node], m_neighborhood.getEdgeWeightToNeighbor(0));
+
+    return true;
+}
+
+
+Gain FMRefinement::toKey(double gain) const
+{
+    double key = floor(gain * m_gainScale + 0.5);
+
+    key = min(key, static_cast<double>(numeric_limits<Gain>::max()));
+    key = max(key, static_cast<double>(numeric_limits<Gain>::min() + 1));
+
+    return static_cast<Gain>(key);
+}
+
+
+template NodeID FMRefinement::refine<ModularityObjective>(const PartitionConfig &config, const ClusteringGraph &G,
+                                                          vector<PartitionID> &clustering,
+                                                          ObjectiveMetric<ModularityObjective> &objective);
+template NodeID FMRefinement::refine<ResolutionModularityObjective>(const PartitionConfig &config, const ClusteringGraph &G,
+                                                                    vector<PartitionID> &clustering,
+                                                                    ObjectiveMetric<ResolutionModularityObjective> &objective);
+template NodeID FMRefinement::refine<ConstantPottsObjective>(const PartitionConfig &config, const ClusteringGraph &G,
+                                                             vector<PartitionID> &clustering,
+                                                             ObjectiveMetric<ConstantPottsObjective> &objective);
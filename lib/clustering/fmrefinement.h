@@ -0,0 +1,82 @@
+/******************************************************************************
+ * fmrefinement.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef FMREFINEMENT_H
+#define FMREFINEMENT_H
+
+#include "clustering/neighborhood.h"
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/priority_queues/maxNodeHeap.h"
+#include "partition/partition_config.h"
+#include "tools/objectivemetric.h"
+
+#include <vector>
+
+
+/**
+ *  \brief k-way FM refinement of a clustering for the objectives of ObjectiveMetric.
+ *
+ *  Unlike the local moves of the Louvain method, which only take positive gains,
+ *  a round moves the boundary nodes in the order of their gains (maxNodeHeap of
+ *  KaHIP), also if the gain is negative, and each node at most once. After a move
+ *  the gains of the neighbors are updated. The round stops if the quality did not
+ *  improve for config.lm_fm_search_depth moves, then the moves after the best
+ *  quality are undone. Rounds are repeated until one does not improve the quality,
+ *  at most config.lm_fm_rounds.
+ *
+ *  The heap has integer keys, the gains are scaled and rounded for it. The quality
+ *  of the prefixes is the exact one of ObjectiveMetric.
+ */
+class FMRefinement
+{
+    public:
+        FMRefinement();
+        virtual ~FMRefinement();
+
+        /**
+            \brief Refines "clustering" of G, "objective" has to keep track of it.
+
+            \return Number of node moves that were kept.
+         */
+        template <typename Objective>
+        NodeID refine(const PartitionConfig &config, const ClusteringGraph &G,
+                      std::vector<PartitionID> &clustering, ObjectiveMetric<Objective> &objective);
+
+    protected:
+        /**
+            \brief One round, returns the number of node moves that were kept.
+         */
+        template <typename Objective, bool UnitNodeWeights>
+        NodeID performRound(const PartitionConfig &config, const ClusteringGraph &G,
+                            std::vector<PartitionID> &clustering, ObjectiveMetric<Objective> &objective);
+
+        /**
+            \brief Computes the neighboring cluster "target" with the maximum gain for "node"
+            and the gain of moving it there (may be negative).
+
+            \return FALSE, if "node" has no neighbor in another cluster.
+         */
+        template <typename Objective, bool UnitNodeWeights>
+        bool computeBestMove(NodeID node, const std::vector<PartitionID> &clustering,
+                             const ObjectiveMetric<Objective> &objective,
+                             PartitionID &target, double &gain);
+
+        /// Key of "gain" in the heap.
+        Gain toKey(double gain) const;
+
+        /// Info about the neighboring clusters of the current node.
+        Neighborhood m_neighborhood;
+        /// TRUE, if the node was moved in the current round.
+        std::vector<bool> m_moved;
+        /// Moved nodes and their previous clusters, in the order of the moves.
+        std::vector<NodeID> m_movedNodes;
+        std::vector<PartitionID> m_previousClusters;
+        /// Factor from gains to heap keys.
+        double m_gainScale;
+};
+
+#endif // FMREFINEMENT_H
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * gainkernel.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "gainkernel.h"
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    /// Shorter neighborhoods are evaluated by the scalar loops, the SIMD setup and reduction do not pay off.
+    const NodeID MINIMUM_SIMD_NEIGHBORS = 16;
+
+    int scalarBestNeighbor(const int *clusterIndices, const EdgeWeight *edgeWeights, NodeID count,
+                           const EdgeWeight *clusterVolumes, double volumePenalty)
+    {
+        int bestPosition = -1;
+        double bestGain = 0.0;
+
+        for (NodeID i = 0; i < count; ++i)
+        {
+            double gain = static_cast<double>(edgeWeights[i])
+                          - static_cast<double>(clusterVolumes[clusterIndices[i]]) * volumePenalty;
+
+            if (bestGain < gain)
+            {
+                bestGain = gain;
+                bestPosition = i;
+            }
+        }
+
+        return bestPosition;
+    }
+
+    int scalarBestNeighborExact(const int *clusterIndices, const EdgeWeight *edgeWeights, NodeID count,
+                                const EdgeWeight *clusterVolumes, EdgeWeight sumOfAllEdgeWeights,
+                                EdgeWeight nodeVolume)
+    {
+        int bestPosition = -1;
+        long long bestGain = 0;
+
+        for (NodeID i = 0; i < count; ++i)
+        {
+            long long gain = static_cast<long long>(edgeWeights[i]) * sumOfAllEdgeWeights
+                             - static_cast<long long>(clusterVolumes[clusterIndices[i]]) * nodeVolume;
+
+            if (bestGain < gain)
+            {
+                bestGain = gain;
+                bestPosition = i;
+            }
+        }
+
+        return bestPosition;
+    }
+
+    /**
+     *  \brief Combines the best gain of each SIMD lane. The lanes keep the first
+     *  maximum of their neighbors, so the smallest position among the lanes with
+     *  the maximum gain is the first maximum overall. Lanes without a positive
+     *  gain have the position -1.
+     */
+    template <typename Gain, typename Position>
+    int reduceLanes(const Gain *gains, const Position *positions, int numberOfLanes)
+    {
+        int bestPosition = -1;
+        Gain bestGain = 0;
+
+        for (int lane = 0; lane < numberOfLanes; ++lane)
+        {
+            int position = static_cast<int>(positions[lane]);
+
+            if (position >= 0 && (bestGain < gains[lane] || (bestGain == gains[lane] && position < bestPosition)))
+            {
+                bestGain = gains[lane];
+                bestPosition = position;
+            }
+        }
+
+        return bestPosition;
+    }
+}
+
+
+int GainKernel::findBestNeighbor(const PartitionID *clusters, const EdgeWeight *edgeWeights,
+                                 NodeID count, const EdgeWeight *clusterVolumes,
+                                 double volumePenalty)
+{
+    const int *clusterIndices = reinterpret_cast<const int *>(clusters);
+
+    if (count < MINIMUM_SIMD_NEIGHBORS)
+    {
+        return scalarBestNeighbor(clusterIndices, edgeWeights, count, clusterVolumes, volumePenalty);
+    }
+
+#if defined(__AVX512F__)
+    // 8 neighbors per iteration: 32 bit loads and gathers (AVX2), double arithmetic (AVX-512)
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512d penalty = _mm512_set1_pd(volumePenalty);
+    const __m512d step = _mm512_set1_pd(8.0);
+    // the zero masked conversions have an explicit zero source, the unmasked ones of GCC an undefined one
+    const __mmask8 allLanes = 0xFF;
+    __m512d positions = _mm512_setr_pd(0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0);
+    __m512d bestGains = _mm512_setzero_pd();
+    __m512d bestPositions = _mm512_set1_pd(-1.0);
+
+    for (NodeID i = 0; i < count; i += 8)
+    {
+        // masked out lanes load 0, their gain 0 never replaces the best one
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count - i)), lanes);
+        __m256i ids = _mm256_maskload_epi32(clusterIndices + i, mask);
+        __m256i weights = _mm256_maskload_epi32(edgeWeights + i, mask);
+        __m256i volumes = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), clusterVolumes, ids, mask, 4);
+
+        __m512d gains = _mm512_sub_pd(_mm512_maskz_cvtepi32_pd(allLanes, weights),
+                                      _mm512_mul_pd(_mm512_maskz_cvtepi32_pd(allLanes, volumes), penalty));
+        __mmask8 better = _mm512_cmp_pd_mask(gains, bestGains, _CMP_GT_OQ);
+
+        bestGains = _mm512_mask_blend_pd(better, bestGains, gains);
+        bestPositions = _mm512_mask_blend_pd(better, bestPositions, positions);
+        positions = _mm512_add_pd(positions, step);
+    }
+
+    double laneGains[8];
+    double lanePositions[8];
+    _mm512_storeu_pd(laneGains, bestGains);
+    _mm512_storeu_pd(lanePositions, bestPositions);
+
+    return reduceLanes(laneGains, lanePositions, 8);
+#elif defined(__AVX2__)
+    // 4 neighbors per iteration, the positions are kept as doubles for the blends
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m256d penalty = _mm256_set1_pd(volumePenalty);
+    const __m256d step = _mm256_set1_pd(4.0);
+    __m256d positions = _mm256_setr_pd(0.0, 1.0, 2.0, 3.0);
+    __m256d bestGains = _mm256_setzero_pd();
+    __m256d bestPositions = _mm256_set1_pd(-1.0);
+
+    for (NodeID i = 0; i < count; i += 4)
+    {
+        __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(count - i)), lanes);
+        __m128i ids = _mm_maskload_epi32(clusterIndices + i, mask);
+        __m128i weights = _mm_maskload_epi32(edgeWeights + i, mask);
+        __m128i volumes = _mm_mask_i32gather_epi32(_mm_setzero_si128(), clusterVolumes, ids, mask, 4);
+
+        __m256d gains = _mm256_sub_pd(_mm256_cvtepi32_pd(weights),
+                                      _mm256_mul_pd(_mm256_cvtepi32_pd(volumes), penalty));
+        __m256d better = _mm256_cmp_pd(gains, bestGains, _CMP_GT_OQ);
+
+        bestGains = _mm256_blendv_pd(bestGains, gains, better);
+        bestPositions = _mm256_blendv_pd(bestPositions, positions, better);
+        positions = _mm256_add_pd(positions, step);
+    }
+
+    double laneGains[4];
+    double lanePositions[4];
+    _mm256_storeu_pd(laneGains, bestGains);
+    _mm256_storeu_pd(lanePositions, bestPositions);
+
+    return reduceLanes(laneGains, lanePositions, 4);
+#else
+    return scalarBestNeighbor(clusterIndices, edgeWeights, count, clusterVolumes, volumePenalty);
+#endif
+}
+
+
+int GainKernel::findBestNeighborExact(const PartitionID *clusters, const EdgeWeight *edgeWeights,
+                                      NodeID count, const EdgeWeight *clusterVolumes,
+                                      EdgeWeight sumOfAllEdgeWeights, EdgeWeight nodeVolume)
+{
+    const int *clusterIndices = reinterpret_cast<const int *>(clusters);
+
+    if (count < MINIMUM_SIMD_NEIGHBORS)
+    {
+        return scalarBestNeighborExact(clusterIndices, edgeWeights, count, clusterVolumes,
+                                       sumOfAllEdgeWeights, nodeVolume);
+    }
+
+#if defined(__AVX512F__)
+    // both factors of each product fit into 32 bits, _mm512_mul_epi32 gives the 64 bit product
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m512i sum = _mm512_set1_epi64(sumOfAllEdgeWeights);
+    const __m512i volume = _mm512_set1_epi64(nodeVolume);
+    const __m512i step = _mm512_set1_epi64(8);
+    const __mmask8 allLanes = 0xFF;
+    __m512i positions = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+    __m512i bestGains = _mm512_setzero_si512();
+    __m512i bestPositions = _mm512_set1_epi64(-1);
+
+    for (NodeID i = 0; i < count; i += 8)
+    {
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(count - i)), lanes);
+        __m256i ids = _mm256_maskload_epi32(clusterIndices + i, mask);
+        __m256i weights = _mm256_maskload_epi32(edgeWeights + i, mask);
+        __m256i volumes = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), clusterVolumes, ids, mask, 4);
+
+        __m512i gains = _mm512_sub_epi64(
+            _mm512_maskz_mul_epi32(allLanes, _mm512_maskz_cvtepi32_epi64(allLanes, weights), sum),
+            _mm512_maskz_mul_epi32(allLanes, _mm512_maskz_cvtepi32_epi64(allLanes, volumes), volume));
+        __mmask8 better = _mm512_cmpgt_epi64_mask(gains, bestGains);
+
+        bestGains = _mm512_mask_blend_epi64(better, bestGains, gains);
+        bestPositions = _mm512_mask_blend_epi64(better, bestPositions, positions);
+        positions = _mm512_add_epi64(positions, step);
+    }
+
+    long long laneGains[8];
+    long long lanePositions[8];
+    _mm512_storeu_si512(laneGains, bestGains);
+    _mm512_storeu_si512(lanePositions, bestPositions);
+
+    return reduceLanes(laneGains, lanePositions, 8);
+#elif defined(__AVX2__)
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+    const __m256i sum = _mm256_set1_epi64x(sumOfAllEdgeWeights);
+    const __m256i volume = _mm256_set1_epi64x(nodeVolume);
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i positions = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i bestGains = _mm256_setzero_si256();
+    __m256i bestPositions = _mm256_set1_epi64x(-1);
+
+    for (NodeID i = 0; i < count; i += 4)
+    {
+        __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(static_cast<int>(count - i)), lanes);
+        __m128i ids = _mm_maskload_epi32(clusterIndices + i, mask);
+        __m128i weights = _mm_maskload_epi32(edgeWeights + i, mask);
+        __m128i volumes = _mm_mask_i32gather_epi32(_mm_setzero_si128(), clusterVolumes, ids, mask, 4);
+
+        __m256i gains = _mm256_sub_epi64(_mm256_mul_epi32(_mm256_cvtepi32_epi64(weights), sum),
+                                         _mm256_mul_epi32(_mm256_cvtepi32_epi64(volumes), volume));
+        __m256i better = _mm256_cmpgt_epi64(gains, bestGains);
+
+        bestGains = _mm256_blendv_epi8(bestGains, gains, better);
+        bestPositions = _mm256_blendv_epi8(bestPositions, positions, better);
+        positions = _mm256_add_epi64(positions, step);
+    }
+
+    long long laneGains[4];
+    long long lanePositions[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(laneGains), bestGains);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(lanePositions), bestPositions);
+
+    return reduceLanes(laneGains, lanePositions, 4);
+#else
+    return scalarBestNeighborExact(clusterIndices, edgeWeights, count, clusterVolumes,
+                                   sumOfAllEdgeWeights, nodeVolume);
+#endif
+}
@@ -0,0 +1,54 @@
+/******************************************************************************
+ * gainkernel.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef GAINKERNEL_H
+#define GAINKERNEL_H
+
+#include "definitions.h"
+
+
+/**
+ *  \brief Evaluates the gains of all clusters in the neighborhood of a node
+ *  at once and returns the best one.
+ *
+ *  The neighborhood is given as contiguous arrays (see Neighborhood): "clusters"
+ *  and "edgeWeights" with "count" entries. The volume of cluster c is
+ *  clusterVolumes[c]. The kernels are vectorized with AVX-512 or AVX2 if the
+ *  compiler targets them (-march=native), otherwise scalar. The last chunk is
+ *  masked, so all neighbors take the same arithmetic path.
+ *
+ *  Both return the position of the first neighbor with the maximum gain,
+ *  or -1 if no gain is positive (as the scalar loop with "bestGain < gain"
+ *  and a start value of 0).
+ */
+class GainKernel
+{
+    public:
+        /**
+            \brief Maximizes edgeWeights[i] - volumePenalty * clusterVolumes[clusters[i]].
+
+            \param volumePenalty Penalty of the objective times the volume of the node,
+            so the kernel only multiplies (no division per neighbor).
+         */
+        static int findBestNeighbor(const PartitionID *clusters, const EdgeWeight *edgeWeights,
+                                    NodeID count, const EdgeWeight *clusterVolumes,
+                                    double volumePenalty);
+
+        /**
+            \brief Exact version for modularity, maximizes the 64 bit integer
+            edgeWeights[i] * sumOfAllEdgeWeights - clusterVolumes[clusters[i]] * nodeVolume.
+
+            That is the modularity gain multiplied by sumOfAllEdgeWeights, so the
+            comparisons do not depend on rounding (and on the instruction set).
+            sumOfAllEdgeWeights has to fit into an EdgeWeight.
+         */
+        static int findBestNeighborExact(const PartitionID *clusters, const EdgeWeight *edgeWeights,
+                                         NodeID count, const EdgeWeight *clusterVolumes,
+                                         EdgeWeight sumOfAllEdgeWeights, EdgeWeight nodeVolume);
+};
+
+#endif // GAINKERNEL_H
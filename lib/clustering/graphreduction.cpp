@@ -0,0 +1,256 @@
+/******************************************************************************
+ * graphreduction.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "graphreduction.h"
+
+#include "clustering/coarsening/contractor.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <utility>
+
+using namespace std;
+
+/// Neighbors of node that are not folded, sorted by ID.
+static void collectRemainingNeighbors(const ClusteringGraph &G, const vector<NodeID> &parent,
+                                      NodeID node, vector<pair<NodeID, EdgeWeight> > &neighbors)
+{
+    neighbors.clear();
+
+    forall_out_edges(G, e, node)
+    {
+        NodeID target = G.getEdgeTarget(e);
+
+        if (parent[target] == target)
+        {
+            neighbors.push_back(make_pair(target, G.getEdgeWeight(e)));
+        }
+    } endfor
+
+    sort(neighbors.begin(), neighbors.end());
+}
+
+
+NodeID GraphReduction::reduce(const PartitionConfig &config, graph_access &G, graph_access &reduced,
+                              vector<NodeID> &mapping)
+{
+    ClusteringGraph finer;
+    ClusteringGraph coarser;
+    vector<NodeID> parent;
+    vector<EdgeWeight> internalWeight;
+    vector<NodeID> twin;
+
+    finer.build(G);
+
+    foldPendantTrees(finer, config.reduce_graph_trees, parent, internalWeight);
+
+    if (config.reduce_graph_twins)
+    {
+        findTwins(finer, parent, internalWeight, twin);
+    }
+    else
+    {
+        twin.resize(G.number_of_nodes());
+        forall_nodes(G, node)
+        {
+            twin[node] = node;
+        } endfor
+    }
+
+    // each node is mapped to the remaining node it is folded into,
+    // chains of anchors are compressed on the way
+    mapping.resize(G.number_of_nodes());
+    forall_nodes(G, node)
+    {
+        NodeID anchor = node;
+
+        while (parent[anchor] != anchor)
+        {
+            anchor = parent[anchor];
+        }
+
+        NodeID current = node;
+        while (parent[current] != anchor && current != anchor)
+        {
+            NodeID next = parent[current];
+            parent[current] = anchor;
+            current = next;
+        }
+
+        mapping[node] = twin[anchor];
+    } endfor
+
+    NodeID numberOfNodes = Contractor::contractClustering(finer, mapping, coarser);
+    coarser.copyTo(reduced);
+
+    return numberOfNodes;
+}
+
+
+void GraphReduction::liftClustering(graph_access &reduced, const vector<NodeID> &mapping,
+                                    graph_access &G)
+{
+    forall_nodes(G, node)
+    {
+        G.setPartitionIndex(node, reduced.getPartitionIndex(mapping[node]));
+    } endfor
+
+    G.set_partition_count(reduced.get_partition_count());
+}
+
+
+void GraphReduction::foldPendantTrees(const ClusteringGraph &G, bool trees, vector<NodeID> &parent,
+                                      vector<EdgeWeight> &internalWeight)
+{
+    /// number of neighbors that are not folded
+    vector<NodeID> remainingDegree(G.number_of_nodes());
+    /// nodes with a single remaining neighbor (may be outdated)
+    vector<NodeID> pendant;
+
+    parent.resize(G.number_of_nodes());
+    internalWeight.resize(G.number_of_nodes());
+
+    forall_nodes(G, node)
+    {
+        parent[node] = node;
+        internalWeight[node] = G.getSelfLoop(node);
+        remainingDegree[node] = G.getNodeDegree(node);
+
+        if (remainingDegree[node] == 1 && (trees || G.getSelfLoop(node) == 0))
+        {
+            pendant.push_back(node);
+        }
+    } endfor
+
+    while (!pendant.empty())
+    {
+        NodeID node = pendant.back();
+        pendant.pop_back();
+
+        if (parent[node] != node || remainingDegree[node] != 1)
+        {
+            continue;
+        }
+
+        NodeID anchor = UNDEFINED_NODE;
+        EdgeWeight weight = 0;
+
+        forall_out_edges(G, e, node)
+        {
+            NodeID target = G.getEdgeTarget(e);
+
+            if (parent[target] == target)
+            {
+                anchor = target;
+                weight = G.getEdgeWeight(e);
+                break;
+            }
+        } endfor
+
+        // only the unit pendant edge is safe, a heavy chain or tree
+        // is better kept as an own node, it may form its own cluster
+        if (trees ? 2 * weight < internalWeight[node] : weight != 1)
+        {
+            continue;
+        }
+
+        parent[node] = anchor;
+        internalWeight[anchor] += internalWeight[node] + 2 * weight;
+        remainingDegree[anchor]--;
+
+        if (trees && remainingDegree[anchor] == 1)
+        {
+            pendant.push_back(anchor);
+        }
+    }
+}
+
+
+void GraphReduction::findTwins(const ClusteringGraph &G, const vector<NodeID> &parent,
+                               const vector<EdgeWeight> &internalWeight,
+                               vector<NodeID> &twin)
+{
+    /// hash of the remaining neighborhood of each candidate
+    vector<pair<uint64_t, NodeID> > keys;
+    vector<pair<NodeID, EdgeWeight> > neighbors;
+
+    twin.resize(G.number_of_nodes());
+
+    forall_nodes(G, node)
+    {
+        twin[node] = node;
+
+        if (parent[node] != node)
+        {
+            continue;
+        }
+
+        collectRemainingNeighbors(G, parent, node, neighbors);
+
+        // twins of degree one are already folded
+        if (neighbors.size() < 2)
+        {
+            continue;
+        }
+
+        uint64_t hash = internalWeight[node];
+        for (NodeID i = 0; i < neighbors.size(); ++i)
+        {
+            uint64_t value = ((uint64_t) neighbors[i].first << 32) ^ (uint32_t) neighbors[i].second;
+            hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+
+        keys.push_back(make_pair(hash, node));
+    } endfor
+
+    sort(keys.begin(), keys.end());
+
+    /// distinct neighborhoods among the nodes with the same hash
+    vector<NodeID> representatives;
+    vector<vector<pair<NodeID, EdgeWeight> > > representativeNeighbors;
+
+    for (NodeID begin = 0; begin < keys.size(); )
+    {
+        NodeID end = begin + 1;
+        while (end < keys.size() && keys[end].first == keys[begin].first)
+        {
+            ++end;
+        }
+
+        if (end - begin > 1)
+        {
+            representatives.clear();
+            representativeNeighbors.clear();
+
+            for (NodeID k = begin; k < end; ++k)
+            {
+                NodeID node = keys[k].second;
+                bool found = false;
+
+                collectRemainingNeighbors(G, parent, node, neighbors);
+
+                for (NodeID r = 0; r < representatives.size() && !found; ++r)
+                {
+                    if (internalWeight[representatives[r]] == internalWeight[node] &&
+                        representativeNeighbors[r] == neighbors)
+                    {
+                        twin[node] = representatives[r];
+                        found = true;
+                    }
+                }
+
+                if (!found)
+                {
+                    representatives.push_back(node);
+                    representativeNeighbors.push_back(neighbors);
+                }
+            }
+        }
+
+        begin = end;
+    }
+}
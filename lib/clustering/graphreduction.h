@@ -0,0 +1,83 @@
+/******************************************************************************
+ * graphreduction.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef GRAPHREDUCTION_H
+#define GRAPHREDUCTION_H
+
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/graph_access.h"
+#include "partition/partition_config.h"
+
+#include <vector>
+
+
+/**
+ *  \brief Shrinks a graph before clustering and lifts the clustering back.
+ *
+ *  Pendant vertices of degree one with a unit edge and without self loop
+ *  are always folded into their only neighbor (anchor). In an optimal
+ *  clustering such a vertex belongs to the cluster of its anchor.
+ *
+ *  Two heuristics can be switched on in addition, they may exclude all
+ *  optimal clusterings:
+ *  - reduce_graph_trees: dangling chains and trees are folded by repeating
+ *    the fold, a vertex whose only remaining neighbor is u is folded into u
+ *    as long as the edge to u is not lighter than the weight already folded
+ *    into the vertex. Weighted pendant edges and self loops are allowed.
+ *  - reduce_graph_twins: structurally identical twins (same neighbors with
+ *    the same edge weights and the same self loop) are merged.
+ *
+ *  Folded vertices are contracted into their anchors (node weights are summed,
+ *  the edges inside become self loops as in Contractor), so the modularity of
+ *  a clustering of the reduced graph equals the modularity of the lifted clustering.
+ */
+class GraphReduction
+{
+    public:
+        /**
+            \brief Builds the reduced graph.
+
+            \param config Selects the heuristic reductions (reduce_graph_trees, reduce_graph_twins).
+            \param G Input graph.
+            \param reduced [out] Reduced graph with node weights and self loops.
+            \param mapping [out] Node of reduced for each node of G.
+
+            \return Number of nodes of reduced.
+         */
+        static NodeID reduce(const PartitionConfig &config, graph_access &G, graph_access &reduced,
+                             std::vector<NodeID> &mapping);
+
+        /**
+            \brief Sets the clustering of G to the clustering of reduced.
+         */
+        static void liftClustering(graph_access &reduced, const std::vector<NodeID> &mapping,
+                                   graph_access &G);
+
+    protected:
+        /**
+            \brief Folds pendant vertices and, if trees is set, dangling chains and trees.
+
+            \param trees Also fold weighted pendant vertices, pendant vertices with self loops
+            and vertices that become pendant by the folding.
+            \param parent [out] Anchor a node is folded into, the node itself if it is not folded.
+            \param internalWeight [out] Weight of the self loop of each remaining node after
+            the folding (edges inside count twice, as in Contractor).
+         */
+        static void foldPendantTrees(const ClusteringGraph &G, bool trees, std::vector<NodeID> &parent,
+                                     std::vector<EdgeWeight> &internalWeight);
+
+        /**
+            \brief Finds structurally identical twins among the nodes that are not folded.
+
+            \param twin [out] Smallest twin of each node (the node itself, if it has no twin).
+         */
+        static void findTwins(const ClusteringGraph &G, const std::vector<NodeID> &parent,
+                              const std::vector<EdgeWeight> &internalWeight,
+                              std::vector<NodeID> &twin);
+};
+
+#endif // GRAPHREDUCTION_H
@@ -0,0 +1,231 @@
+/******************************************************************************
+ * heavynodes.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "heavynodes.h"
+
+#include "tools/random_functions.h"
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    /// Minimum number of edges per chunk, smaller chunks do not pay for the merge.
+    const EdgeID MINIMUM_CHUNK_EDGES = 4096;
+}
+
+
+HeavyNodeAggregation::HeavyNodeAggregation()
+    : m_degreeThreshold(0), m_sampleSize(0), m_sampling(false), m_wasSampled(false)
+{
+    //ctor
+}
+
+
+HeavyNodeAggregation::~HeavyNodeAggregation()
+{
+    //dtor
+}
+
+
+void HeavyNodeAggregation::initialize(NodeID degreeThreshold, NodeID sampleSize)
+{
+    m_degreeThreshold = degreeThreshold;
+    m_sampleSize = sampleSize;
+    m_sampling = false;
+}
+
+
+void HeavyNodeAggregation::ClusterTable::reset(NodeID maximumSize)
+{
+    // at most half full
+    NodeID capacity = 2;
+    while (capacity < 2 * maximumSize)
+    {
+        capacity *= 2;
+    }
+
+    keys.assign(capacity, UNDEFINED_NODE);
+    values.resize(capacity);
+    insertionOrder.clear();
+    mask = capacity - 1;
+}
+
+
+void HeavyNodeAggregation::ClusterTable::add(PartitionID cluster, EdgeWeight weight)
+{
+    // multiplicative hashing, the high bits of the product are the well mixed ones
+    NodeID slot = static_cast<NodeID>((static_cast<unsigned long long>(cluster) * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+
+    while (keys[slot] != cluster && keys[slot] != UNDEFINED_NODE)
+    {
+        slot = (slot + 1) & mask;
+    }
+
+    if (keys[slot] == UNDEFINED_NODE)
+    {
+        keys[slot] = cluster;
+        values[slot] = 0;
+        insertionOrder.push_back(slot);
+    }
+    values[slot] += weight;
+}
+
+
+template <bool UnitEdgeWeights>
+NodeID HeavyNodeAggregation::aggregate(const ClusteringGraph &G, NodeID node,
+                                       const vector<PartitionID> &clustering)
+{
+    EdgeID begin = G.get_first_edge(node);
+    EdgeID end = G.get_first_invalid_edge(node);
+    EdgeID degree = end - begin;
+
+    m_wasSampled = m_sampling && degree > m_sampleSize;
+
+    if (m_wasSampled)
+    {
+        // every step-th edge, each sampled edge stands for step edges
+        EdgeID step = degree / m_sampleSize;
+        EdgeID offset = random_functions::nextInt(0, step - 1);
+
+        m_mergedTable.reset((degree - offset + step - 1) / step);
+        aggregateChunk<UnitEdgeWeights>(G, begin + offset, end, step, step, clustering, m_mergedTable);
+
+        return output(m_mergedTable);
+    }
+
+    EdgeID numberOfChunks = 1;
+#ifdef _OPENMP
+    numberOfChunks = min<EdgeID>(omp_get_max_threads(), degree / MINIMUM_CHUNK_EDGES);
+#endif
+
+    if (numberOfChunks <= 1)
+    {
+        m_mergedTable.reset(degree);
+        aggregateChunk<UnitEdgeWeights>(G, begin, end, 1, 1, clustering, m_mergedTable);
+
+        return output(m_mergedTable);
+    }
+
+    if (m_chunkTables.size() < numberOfChunks)
+    {
+        m_chunkTables.resize(numberOfChunks);
+    }
+
+    EdgeID chunkSize = (degree + numberOfChunks - 1) / numberOfChunks;
+
+    #pragma omp parallel for num_threads(numberOfChunks) schedule(static, 1)
+    for (int chunk = 0; chunk < static_cast<int>(numberOfChunks); ++chunk)
+    {
+        EdgeID chunkBegin = min(end, begin + chunk * chunkSize);
+        EdgeID chunkEnd = min(end, chunkBegin + chunkSize);
+
+        m_chunkTables[chunk].reset(chunkEnd - chunkBegin);
+        aggregateChunk<UnitEdgeWeights>(G, chunkBegin, chunkEnd, 1, 1, clustering, m_chunkTables[chunk]);
+    }
+
+    // the first edge to a cluster is in the first chunk that contains it,
+    // so merging the chunks in order keeps the order of the first edges
+    NodeID numberOfEntries = 0;
+    for (EdgeID chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+        numberOfEntries += m_chunkTables[chunk].insertionOrder.size();
+    }
+
+    m_mergedTable.reset(numberOfEntries);
+    for (EdgeID chunk = 0; chunk < numberOfChunks; ++chunk)
+    {
+        const ClusterTable &table = m_chunkTables[chunk];
+
+        for (NodeID i = 0, size = table.insertionOrder.size(); i < size; ++i)
+        {
+            NodeID slot = table.insertionOrder[i];
+            m_mergedTable.add(table.keys[slot], table.values[slot]);
+        }
+    }
+
+    return output(m_mergedTable);
+}
+
+
+template <bool UnitEdgeWeights>
+NodeID HeavyNodeAggregation::aggregate(const CompressedGraph &G, NodeID node,
+                                       const vector<PartitionID> &clustering)
+{
+    EdgeID degree = G.getNodeDegree(node);
+    // without sampling every edge is taken
+    EdgeID step = 1;
+    EdgeID offset = 0;
+
+    m_wasSampled = m_sampling && degree > m_sampleSize;
+
+    if (m_wasSampled)
+    {
+        step = degree / m_sampleSize;
+        offset = random_functions::nextInt(0, step - 1);
+    }
+
+    m_mergedTable.reset((degree - offset + step - 1) / step);
+
+    EdgeID i = 0;
+    forall_neighbors(G, node, target, weight, UnitEdgeWeights)
+    {
+        if (i >= offset && (i - offset) % step == 0)
+        {
+            m_mergedTable.add(clustering[target], step * weight);
+        }
+        ++i;
+    } endfor
+
+    return output(m_mergedTable);
+}
+
+
+template <bool UnitEdgeWeights>
+void HeavyNodeAggregation::aggregateChunk(const ClusteringGraph &G, EdgeID begin, EdgeID end, EdgeID step,
+                                          EdgeWeight weightFactor, const vector<PartitionID> &clustering,
+                                          ClusterTable &table)
+{
+    for (EdgeID e = begin; e < end; e += step)
+    {
+        table.add(clustering[G.getEdgeTarget(e)], weightFactor * G.getEdgeWeight<UnitEdgeWeights>(e));
+    }
+}
+
+
+NodeID HeavyNodeAggregation::output(const ClusterTable &table)
+{
+    NodeID size = table.insertionOrder.size();
+
+    m_clusters.resize(size);
+    m_edgeWeights.resize(size);
+
+    for (NodeID i = 0; i < size; ++i)
+    {
+        NodeID slot = table.insertionOrder[i];
+
+        m_clusters[i] = table.keys[slot];
+        m_edgeWeights[i] = table.values[slot];
+    }
+
+    return size;
+}
+
+
+template NodeID HeavyNodeAggregation::aggregate<true>(const ClusteringGraph &G, NodeID node,
+                                                      const vector<PartitionID> &clustering);
+template NodeID HeavyNodeAggregation::aggregate<false>(const ClusteringGraph &G, NodeID node,
+                                                       const vector<PartitionID> &clustering);
+template NodeID HeavyNodeAggregation::aggregate<true>(const CompressedGraph &G, NodeID node,
+                                                      const vector<PartitionID> &clustering);
+template NodeID HeavyNodeAggregation::aggregate<false>(const CompressedGraph &G, NodeID node,
+                                                       const vector<PartitionID> &clustering);
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * heavynodes.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef HEAVYNODES_H
+#define HEAVYNODES_H
+
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
+
+#include <vector>
+
+
+/**
+ *  \brief Aggregates the adjacency of a node of very high degree (a hub of a
+ *  power law graph) by the clusters of its neighbors.
+ *
+ *  The out edges are split into one chunk per OpenMP thread. Each chunk is
+ *  aggregated into its own small hash table, then the chunks are merged in
+ *  order. The result lists each neighboring cluster once, in the order of
+ *  the first edge to it, with the exact edge weight, i.e. the same as the
+ *  sequential loop produces. The tables are as large as the degree, not as
+ *  the graph.
+ *
+ *  Optionally the edges are sampled instead (every k-th edge starting at a
+ *  random edge, weights multiplied by k), which is not exact.
+ *
+ *  The neighbors of a CompressedGraph can only be decoded in order, there a
+ *  heavy node is aggregated in a single chunk (with the same result).
+ */
+class HeavyNodeAggregation
+{
+    public:
+        HeavyNodeAggregation();
+        virtual ~HeavyNodeAggregation();
+
+        /**
+            \brief Sets the parameters.
+
+            \param degreeThreshold Nodes with more out edges are heavy, 0 means no node is heavy.
+            \param sampleSize If non-zero, heavy nodes rate only about this many of their
+            edges while sampling is enabled.
+         */
+        void initialize(NodeID degreeThreshold, NodeID sampleSize);
+
+        /// Enables or disables the sampling (if a sample size is set).
+        void setSampling(bool sampling) { m_sampling = sampling && m_sampleSize > 0; }
+
+        /// Returns TRUE, if "node" is handled as a heavy node.
+        template <typename Graph>
+        bool isHeavy(const Graph &G, NodeID node) const
+        {
+            return m_degreeThreshold > 0 && G.getNodeDegree(node) > m_degreeThreshold;
+        }
+
+        /**
+            \brief Aggregates the out edges of "node" by clustering[target].
+
+            \return Number of neighboring clusters, see getClusters() and getEdgeWeights().
+         */
+        template <bool UnitEdgeWeights>
+        NodeID aggregate(const ClusteringGraph &G, NodeID node, const std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Same as above for a CompressedGraph, sequentially.
+         */
+        template <bool UnitEdgeWeights>
+        NodeID aggregate(const CompressedGraph &G, NodeID node, const std::vector<PartitionID> &clustering);
+
+        /// Neighboring clusters of the last aggregate(), in order of the first edge.
+        const PartitionID *getClusters() const { return &m_clusters[0]; }
+        /// Edge weights to getClusters().
+        const EdgeWeight *getEdgeWeights() const { return &m_edgeWeights[0]; }
+        /// Returns TRUE, if the last aggregate() sampled the edges (the weights are estimates).
+        bool wasSampled() const { return m_wasSampled; }
+
+    protected:
+        /**
+            \brief Open addressing hash table from cluster IDs to edge weights
+            that remembers the insertion order.
+         */
+        struct ClusterTable
+        {
+            std::vector<PartitionID> keys;
+            std::vector<EdgeWeight> values;
+            std::vector<NodeID> insertionOrder;
+            NodeID mask;
+
+            /// Empties the table for at most "maximumSize" keys.
+            void reset(NodeID maximumSize);
+            void add(PartitionID cluster, EdgeWeight weight);
+        };
+
+        /**
+            \brief Aggregates the out edges [begin, end) of "node" into "table".
+         */
+        template <bool UnitEdgeWeights>
+        static void aggregateChunk(const ClusteringGraph &G, EdgeID begin, EdgeID end, EdgeID step,
+                                   EdgeWeight weightFactor, const std::vector<PartitionID> &clustering,
+                                   ClusterTable &table);
+
+        /// Copies "table" to m_clusters and m_edgeWeights.
+        NodeID output(const ClusterTable &table);
+
+        NodeID m_degreeThreshold;
+        NodeID m_sampleSize;
+        bool m_sampling;
+        bool m_wasSampled;
+        /// One table per chunk.
+        std::vector<ClusterTable> m_chunkTables;
+        /// Merged table of all chunks.
+        ClusterTable m_mergedTable;
+        /// Result of the last aggregate().
+        std::vector<PartitionID> m_clusters;
+        std::vector<EdgeWeight> m_edgeWeights;
+};
+
+#endif // HEAVYNODES_H
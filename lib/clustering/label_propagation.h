@@ -28,7 +28,7 @@ public:
         // coarse_mappng stores cluster id and the mapping (it is identical)
         std::vector<NodeID> permutation(G.number_of_nodes());
         cluster_id.resize(G.number_of_nodes());
-        random_functions::setSeed(time(NULL));
+        // the random state is seeded by the caller (--seed), so the result is reproducible
         std::vector<PartitionID> hash_map(G.number_of_nodes(),0);
 
         for (size_t i = 0; i < cluster_id.size(); ++i) {
@@ -8,11 +8,15 @@
 #include "labelpropagation.h"
 
 #include "clustering/coarsening/coarsening.h"
+#include "clustering/heavynodes.h"
 #include "partition/coarsening/clustering/node_ordering.h"
 #include "partition/coarsening/contraction.h"
 #include "timer.h"
 #include "tools/modularitymetric.h"
+#include "tools/random_functions.h"
+#include "tools/visitorder.h"
 
+#include <algorithm>
 #include <list>
 
 using namespace std;
@@ -240,3 +244,158 @@ NodeID LabelPropagation::performLabelPropagation(const PartitionConfig& config,
 
     return lp.performLabelPropagation(config);
 }
+
+
+NodeID LabelPropagation::performLabelPropagation(const PartitionConfig& config,
+                                                 const ClusteringGraph &G,
+                                                 vector<PartitionID> &clustering)
+{
+    if (G.hasUnitEdgeWeights())
+    {
+        return propagateLabels<true>(config, G, clustering);
+    }
+
+    return propagateLabels<false>(config, G, clustering);
+}
+
+
+NodeID LabelPropagation::performLabelPropagation(const PartitionConfig& config,
+                                                 const CompressedGraph &G,
+                                                 vector<PartitionID> &clustering)
+{
+    if (G.hasUnitEdgeWeights())
+    {
+        return propagateLabels<true>(config, G, clustering);
+    }
+
+    return propagateLabels<false>(config, G, clustering);
+}
+
+
+template <bool UnitEdgeWeights, typename Graph>
+NodeID LabelPropagation::propagateLabels(const PartitionConfig& config,
+                                         const Graph &G,
+                                         vector<PartitionID> &clustering)
+{
+    /// random order of nodes how we traverse them
+    vector<NodeID> permutation(G.number_of_nodes());
+    /// number of node moves between clusters (in last iteration)
+    NodeID numberOfNodeMoves = 0;
+    /// edge weights to local clusters in the neighborhood
+    vector<EdgeWeight> edgeWeightsToClusters(G.number_of_nodes(), 0);
+    /// aggregation of the out edges of nodes of high degree
+    HeavyNodeAggregation heavyNodes;
+
+    heavyNodes.initialize(config.lm_heavy_node_degree, config.lm_heavy_node_sample);
+
+    // same order as node_ordering::order_nodes()
+    forall_nodes(G, node)
+    {
+        permutation[node] = node;
+    } endfor
+
+    switch (config.node_ordering)
+    {
+        case RANDOM_NODEORDERING:
+            if (config.lm_visit_block_edges > 0)
+            {
+                VisitOrder::blockPermutation(G, config.lm_visit_block_edges, permutation);
+            }
+            else
+            {
+                random_functions::permutate_vector_fast(permutation, false);
+            }
+            break;
+        case DEGREE_NODEORDERING:
+            sort(permutation.begin(), permutation.end(),
+                 [&](const NodeID &lhs, const NodeID &rhs) -> bool {
+                     return G.getNodeDegree(lhs) < G.getNodeDegree(rhs);
+                 });
+            break;
+    }
+
+    for (unsigned i = 0; i < config.lm_number_of_label_propagation_iterations; ++i)
+    {
+        // to know whether there was a change in the inner loop
+        NodeID oldNumberOfNodeMoves = numberOfNodeMoves;
+
+        // heavy nodes rate only a sample of their edges in the first iteration
+        heavyNodes.setSampling(i == 0);
+
+        forall_nodes(G, nn)
+        {
+            NodeID node = permutation[nn];
+            PartitionID oldCluster = clustering[node];
+            PartitionID bestCluster = oldCluster;
+            EdgeWeight bestWeight = 0;
+
+            VisitOrder::prefetchAhead(G, permutation, nn);
+
+            if (heavyNodes.isHeavy(G, node))
+            {
+                NodeID count = heavyNodes.aggregate<UnitEdgeWeights>(G, node, clustering);
+                const PartitionID *clusters = heavyNodes.getClusters();
+                const EdgeWeight *edgeWeights = heavyNodes.getEdgeWeights();
+
+                // the clusters are in the order of their first edge, so this makes
+                // the same choices (and random numbers) as the edge loops below:
+                // there the later edges to a cluster see the weight 0 after the
+                // reset, which never ties with a positive best weight
+                for (NodeID j = 0; j < count; ++j)
+                {
+                    if ((edgeWeights[j] > bestWeight) ||
+                        (edgeWeights[j] == bestWeight && random_functions::nextBool()))
+                    {
+                        bestWeight = edgeWeights[j];
+                        bestCluster = clusters[j];
+                    }
+                }
+
+                if (oldCluster != bestCluster)
+                {
+                    clustering[node] = bestCluster;
+                    numberOfNodeMoves++;
+                }
+                continue;
+            }
+
+            // determine edge weights to neighboring clusters
+            forall_neighbors(G, node, target, weight, UnitEdgeWeights)
+            {
+                edgeWeightsToClusters[clustering[target]] += weight;
+            } endfor
+
+            // find neighboring cluster where we have the most weighted edges to
+            forall_neighbors(G, node, target, weight, UnitEdgeWeights)
+            {
+                PartitionID clusterOfNeighbor = clustering[target];
+                EdgeWeight edgeWeightToCluster = edgeWeightsToClusters[clusterOfNeighbor];
+
+                // when the current weight is equal, then
+                // we choose it by random 50%
+                if ((edgeWeightToCluster > bestWeight) ||
+                    (edgeWeightToCluster == bestWeight && random_functions::nextBool()))
+                {
+                    bestWeight = edgeWeightToCluster;
+                    bestCluster = clusterOfNeighbor;
+                }
+
+                // reset for the next iteration/node
+                edgeWeightsToClusters[clusterOfNeighbor] = 0;
+            } endfor
+
+            if (oldCluster != bestCluster)
+            {
+                clustering[node] = bestCluster;
+                numberOfNodeMoves++;
+            }
+        } endfor
+
+        if (oldNumberOfNodeMoves == numberOfNodeMoves)
+        {
+            break;
+        }
+    }
+
+    return numberOfNodeMoves;
+}
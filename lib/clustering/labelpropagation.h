@@ -8,6 +8,8 @@
 #ifndef LABELPROPAGATION_H
 #define LABELPROPAGATION_H
 
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include "data_structure/graph_hierarchy.h"
 #include "partition/partition_config.h"
@@ -64,7 +66,36 @@ class LabelPropagation
         static NodeID performLabelPropagation(const PartitionConfig &config,
                                               graph_access *G);
 
+
+        /**
+            \brief Performs label propagation on a ClusteringGraph without coarsening.
+
+            Same as above, but the clustering is kept in "clustering"
+            (cluster IDs smaller than the number of nodes).
+
+            \return Number of node moves, total count of all turns.
+         */
+        static NodeID performLabelPropagation(const PartitionConfig &config,
+                                              const ClusteringGraph &G,
+                                              std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Same as above on a CompressedGraph.
+         */
+        static NodeID performLabelPropagation(const PartitionConfig &config,
+                                              const CompressedGraph &G,
+                                              std::vector<PartitionID> &clustering);
+
     protected:
+        /**
+            \brief Label propagation sweeps on a ClusteringGraph or CompressedGraph
+            (see above), instantiated for unit or weighted edges.
+         */
+        template <bool UnitEdgeWeights, typename Graph>
+        static NodeID propagateLabels(const PartitionConfig &config,
+                                      const Graph &G,
+                                      std::vector<PartitionID> &clustering);
+
         /**
             \brief Assigns each node to an own cluster.
          */
@@ -8,14 +8,17 @@
 #include "louvainmethod.h"
 
 #include "clustering/coarsening/coarsening.h"
+#include "clustering/coarsening/contractor.h"
+#include "clustering/fmrefinement.h"
 #include "clustering/labelpropagation.h"
 #include "clustering/neighborhood.h"
+#include "clustering/nodereordering.h"
 #include "coarsening/clustering/size_constraint_label_propagation.h"
 #include "partition/coarsening/clustering/node_ordering.h"
 #include "partition/coarsening/contraction.h"
 #include "timer.h"
-#include "tools/modularitymetric.h"
 #include "tools/random_functions.h"
+#include "tools/visitorder.h"
 
 #include <iomanip>      // setprecision()
 #include <limits>       // numeric_limits<>
@@ -51,6 +54,14 @@ PartitionID LouvainMethod::performClustering(PartitionConfig &config, graph_acce
 PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& config,
                                                     graph_access* G, bool start_w_singletons)
 {
+    m_levelStatistics.clear();
+
+    // only size constrained label propagation (KaHIP) needs graph_access on all levels
+    if (config.lm_cluster_coarsening_factor == 0)
+    {
+        return performClusteringOnClusteringGraph(config, G, start_w_singletons);
+    }
+
     /// number of node moves between clusters
     NodeID numberOfMoves = 0;
     unsigned coarsenings = 0;
@@ -60,6 +71,10 @@ PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& confi
     list<graph_access *> coarseGraphsToDelete;
     /// for measuring fine times
     timer timer;
+    /// compact copy of the current level for the node moves, built once per level
+    ClusteringGraph levelGraph;
+    /// clustering of levelGraph
+    vector<PartitionID> clustering;
 
     m_G = G;
 
@@ -102,8 +117,13 @@ PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& confi
         // only when there was a move we contract
         if (numberOfMoves)
         {
+            LevelStatistics level = { m_G->number_of_nodes(), 0, true, true };
+
             m_G = Coarsening::performCoarsening(config, *m_G, graphHierarchy, coarseGraphsToDelete);
             coarsenings++;
+
+            level.numberOfClusters = m_G->number_of_nodes();
+            m_levelStatistics.push_back(level);
         }
 
 
@@ -127,7 +147,15 @@ PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& confi
 
         // phase 1: maximize modularity by assigning nodes to new clusters
         // as long as there is a (minimum) improvement
-        numberOfMoves = performNodeMoves(config);
+        buildLevel(levelGraph, clustering);
+        numberOfMoves = performNodeMoves(config, levelGraph, clustering);
+
+        // a level that shrinks the graph too little is not worth a contraction
+        if (numberOfMoves && !guardCoarseningWithSCLP(config, levelGraph, clustering))
+        {
+            numberOfMoves = 0;
+        }
+        storeClustering(clustering);
 
         // phase 2: contract nodes/clusters
         // only when there was a move we contract
@@ -161,7 +189,15 @@ PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& confi
         // phase 1: maximize modularity by assigning nodes to new clusters
         // as long as there is a (minimum) improvement
         // refinement of result
-        numberOfMoves = performNodeMoves(config);
+        buildLevel(levelGraph, clustering);
+        numberOfMoves = performNodeMoves(config, levelGraph, clustering);
+
+        // FM moves also with negative gains, to leave local optima of the node moves
+        if (config.lm_fm_refinement)
+        {
+            numberOfMoves += performFMRefinement(config, levelGraph, clustering);
+        }
+        storeClustering(clustering);
     }
 
     // graph hierarchy does not free the coarse graphs
@@ -190,6 +226,22 @@ PartitionID LouvainMethod::performClusteringWithLPP(const PartitionConfig& confi
 }
 
 
+NodeID LouvainMethod::performRefinement(const PartitionConfig &config, graph_access *G)
+{
+    ClusteringGraph levelGraph;
+    vector<PartitionID> clustering;
+
+    m_G = G;
+    buildLevel(levelGraph, clustering);
+
+    NodeID numberOfMoves = performNodeMoves(config, levelGraph, clustering);
+
+    storeClustering(clustering);
+
+    return numberOfMoves;
+}
+
+
 void LouvainMethod::initializeSingletonClusters()
 {
     PartitionID clusterID = 0;
@@ -208,7 +260,502 @@ void LouvainMethod::initializeSingletonClusters()
 }
 
 
-NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
+PartitionID LouvainMethod::performClusteringOnClusteringGraph(const PartitionConfig &config,
+                                                              graph_access *G, bool start_w_singletons)
+{
+    /// first level, built from G
+    ClusteringGraph *first = new ClusteringGraph();
+    /// clustering of G, then of the first level
+    vector<PartitionID> clustering(G->number_of_nodes());
+    /// node v of G is node inputOrder[v] of the first level, if it was reordered
+    vector<NodeID> inputOrder;
+
+    m_G = G;
+
+    first->build(*G);
+
+    forall_nodes((*G), node)
+    {
+        clustering[node] = G->getPartitionIndex(node);
+    } endfor
+
+    bool reordered = reorderNodes(config, first, clustering, inputOrder);
+
+    performClusteringOnLevels(config, first, clustering, start_w_singletons,
+                              config.lm_number_of_label_propagation_levels);
+
+    // write the clustering with consecutive IDs back
+    vector<PartitionID> newMapping(G->number_of_nodes(), UNDEFINED_NODE);
+    PartitionID id = 0;
+
+    forall_nodes((*m_G), node) {
+        PartitionID &cluster = newMapping[clustering[reordered ? inputOrder[node] : node]];
+        if (cluster == UNDEFINED_NODE) { cluster = id++; }
+        m_G->setPartitionIndex(node, cluster);
+    } endfor
+
+    m_G->set_partition_count(id);
+
+    return m_G->get_partition_count();
+}
+
+
+void LouvainMethod::performClusteringOnLevels(const PartitionConfig &config, ClusteringGraph *G,
+                                              vector<PartitionID> &clustering,
+                                              bool start_w_singletons, unsigned numberOfLPLevels)
+{
+    /// number of node moves between clusters
+    NodeID numberOfMoves = 0;
+    /// levels of coarse graphs, the first one is G
+    list<ClusteringGraph *> graphHierarchy(1, G);
+    /// coarse mapping of each level to the next coarser one
+    list<vector<PartitionID> > coarseMappings;
+
+    // to make the graph rapidly smaller we apply some levels of label propagation
+    for (unsigned i = 0; i < numberOfLPLevels; ++i)
+    {
+        ClusteringGraph &current = *graphHierarchy.back();
+
+        if (start_w_singletons) { initializeSingletonClusters(current, clustering); }
+
+        numberOfMoves = LabelPropagation::performLabelPropagation(config, current, clustering);
+
+        if (!numberOfMoves)
+        {
+            break;
+        }
+
+        // the nodes of the coarse graph are the clusters
+        graphHierarchy.push_back(new ClusteringGraph());
+        LevelStatistics level = { current.number_of_nodes(), 0, true, true };
+        level.numberOfClusters = Contractor::contractClustering(current, clustering, *graphHierarchy.back(), config.lm_heavy_node_degree);
+        m_levelStatistics.push_back(level);
+        coarseMappings.push_back(clustering);
+        initializeSingletonClusters(*graphHierarchy.back(), clustering);
+        reorderCoarseLevel(config, graphHierarchy.back(), coarseMappings.back(), clustering);
+    }
+
+    // here starts the standard Louvain algorithm
+    if (config.lm_objective == CPM_OBJECTIVE)
+    {
+        performLouvainLevels(config, graphHierarchy, coarseMappings, clustering, start_w_singletons,
+                             ConstantPottsObjective(config.lm_resolution));
+    }
+    else if (config.lm_resolution != 1.0)
+    {
+        performLouvainLevels(config, graphHierarchy, coarseMappings, clustering, start_w_singletons,
+                             ResolutionModularityObjective(config.lm_resolution));
+    }
+    else
+    {
+        performLouvainLevels(config, graphHierarchy, coarseMappings, clustering, start_w_singletons,
+                             ModularityObjective());
+    }
+
+    delete graphHierarchy.back();
+}
+
+
+PartitionID LouvainMethod::performClustering(const PartitionConfig &config, const CompressedGraph &G,
+                                             vector<PartitionID> &clustering)
+{
+    /// number of node moves between clusters
+    NodeID numberOfMoves = 0;
+    /// TRUE, if the first level is clustered by label propagation
+    bool labelPropagation = config.lm_number_of_label_propagation_levels > 0;
+
+    m_levelStatistics.clear();
+    initializeSingletonClusters(G, clustering);
+
+    // the first level works on G, only its contraction is a ClusteringGraph
+    if (labelPropagation)
+    {
+        numberOfMoves = LabelPropagation::performLabelPropagation(config, G, clustering);
+    }
+    else
+    {
+        numberOfMoves = performNodeMoves(config, G, clustering);
+
+        if (numberOfMoves && !guardCoarsening(config, G, clustering))
+        {
+            numberOfMoves = 0;
+        }
+    }
+
+    if (numberOfMoves)
+    {
+        ClusteringGraph *coarser = new ClusteringGraph();
+        /// cluster of each node of G, the nodes of the coarser graph
+        vector<PartitionID> coarseMapping(clustering);
+        vector<PartitionID> coarseClustering;
+        LevelStatistics level = { G.number_of_nodes(), 0, true, true };
+
+        level.numberOfClusters = Contractor::contractClustering(G, coarseMapping, *coarser, config.lm_heavy_node_degree);
+        if (labelPropagation) { m_levelStatistics.push_back(level); }
+
+        initializeSingletonClusters(*coarser, coarseClustering);
+        reorderCoarseLevel(config, coarser, coarseMapping, coarseClustering);
+
+        performClusteringOnLevels(config, coarser, coarseClustering, true,
+                                  labelPropagation ? config.lm_number_of_label_propagation_levels - 1 : 0);
+
+        forall_nodes(G, node)
+        {
+            clustering[node] = coarseClustering[coarseMapping[node]];
+        } endfor
+
+        // the objective of the coarse levels is not carried over, refine G from scratch
+        performNodeMoves(config, G, clustering);
+    }
+
+    // consecutive cluster IDs
+    vector<PartitionID> newMapping(G.number_of_nodes(), UNDEFINED_NODE);
+    PartitionID id = 0;
+
+    forall_nodes(G, node)
+    {
+        PartitionID &cluster = newMapping[clustering[node]];
+        if (cluster == UNDEFINED_NODE) { cluster = id++; }
+        clustering[node] = cluster;
+    } endfor
+
+    return id;
+}
+
+
+template <typename Objective>
+void LouvainMethod::performLouvainLevels(const PartitionConfig &config,
+                                         list<ClusteringGraph *> &graphHierarchy,
+                                         list<vector<PartitionID> > &coarseMappings,
+                                         vector<PartitionID> &clustering,
+                                         bool start_w_singletons, const Objective &objectivePolicy)
+{
+    /// number of node moves between clusters
+    NodeID numberOfMoves = 0;
+    /// objective of the current level, carried to the finer levels during uncoarsening
+    ObjectiveMetric<Objective> *objective = 0;
+    /// refinement during uncoarsening, keeps its buffers across the levels
+    FMRefinement fmRefinement;
+
+    do
+    {
+        ClusteringGraph &current = *graphHierarchy.back();
+
+        if (start_w_singletons) { initializeSingletonClusters(current, clustering); }
+
+        delete objective;
+        objective = new ObjectiveMetric<Objective>(current, clustering, objectivePolicy);
+        numberOfMoves = performNodeMoves(config, current, clustering, *objective);
+
+        // a level that shrinks the graph too little is not worth a contraction,
+        // then the objective of this level is the one of the uncoarsening
+        if (numberOfMoves && !guardCoarsening(config, current, clustering))
+        {
+            numberOfMoves = 0;
+        }
+
+        if (numberOfMoves)
+        {
+            graphHierarchy.push_back(new ClusteringGraph());
+            Contractor::contractClustering(current, clustering, *graphHierarchy.back(), config.lm_heavy_node_degree);
+            coarseMappings.push_back(clustering);
+            initializeSingletonClusters(*graphHierarchy.back(), clustering);
+            reorderCoarseLevel(config, graphHierarchy.back(), coarseMappings.back(), clustering);
+        }
+    }
+    while (numberOfMoves);
+
+    // uncoarsening, project the clustering to the finer graphs
+    // and do local refinement
+    while (!coarseMappings.empty())
+    {
+        vector<PartitionID> &coarseMapping = coarseMappings.back();
+
+        for (NodeID node = 0; node < coarseMapping.size(); ++node)
+        {
+            coarseMapping[node] = clustering[coarseMapping[node]];
+        }
+        clustering.swap(coarseMapping);
+        coarseMappings.pop_back();
+
+        delete graphHierarchy.back();
+        graphHierarchy.pop_back();
+
+        // the cluster weights do not change by the projection
+        objective->projectTo(*graphHierarchy.back(), clustering);
+        performNodeMoves(config, *graphHierarchy.back(), clustering, *objective);
+
+        // FM moves also with negative gains, to leave local optima of the node moves
+        if (config.lm_fm_refinement)
+        {
+            fmRefinement.refine(config, *graphHierarchy.back(), clustering, *objective);
+        }
+    }
+
+    delete objective;
+}
+
+
+bool LouvainMethod::reorderNodes(const PartitionConfig &config, ClusteringGraph *&G,
+                                 vector<PartitionID> &clustering, vector<NodeID> &newID)
+{
+    if (!NodeReordering::computeOrdering(config, *G, clustering, newID))
+    {
+        return false;
+    }
+
+    ClusteringGraph *reordered = new ClusteringGraph();
+    vector<PartitionID> reorderedClustering(clustering.size());
+
+    NodeReordering::reorder(*G, newID, *reordered);
+    delete G;
+    G = reordered;
+
+    for (NodeID node = 0; node < clustering.size(); ++node)
+    {
+        reorderedClustering[newID[node]] = clustering[node];
+    }
+    clustering.swap(reorderedClustering);
+
+    return true;
+}
+
+
+void LouvainMethod::reorderCoarseLevel(const PartitionConfig &config, ClusteringGraph *&coarser,
+                                       vector<PartitionID> &coarseMapping,
+                                       vector<PartitionID> &clustering)
+{
+    vector<NodeID> newID;
+
+    if (reorderNodes(config, coarser, clustering, newID))
+    {
+        for (NodeID node = 0; node < coarseMapping.size(); ++node)
+        {
+            coarseMapping[node] = newID[coarseMapping[node]];
+        }
+    }
+}
+
+
+NodeID LouvainMethod::countClusters(const vector<PartitionID> &clustering)
+{
+    vector<bool> occurs(clustering.size(), false);
+    NodeID numberOfClusters = 0;
+
+    for (NodeID node = 0; node < clustering.size(); ++node)
+    {
+        if (!occurs[clustering[node]])
+        {
+            occurs[clustering[node]] = true;
+            numberOfClusters++;
+        }
+    }
+
+    return numberOfClusters;
+}
+
+
+void LouvainMethod::buildLevel(ClusteringGraph &G, vector<PartitionID> &clustering) const
+{
+    G.build(*m_G);
+    clustering.resize(m_G->number_of_nodes());
+
+    forall_nodes((*m_G), node)
+    {
+        clustering[node] = m_G->getPartitionIndex(node);
+    } endfor
+}
+
+
+void LouvainMethod::storeClustering(const vector<PartitionID> &clustering)
+{
+    forall_nodes((*m_G), node)
+    {
+        m_G->setPartitionIndex(node, clustering[node]);
+    } endfor
+}
+
+
+template <typename Graph>
+double LouvainMethod::computeQuality(const PartitionConfig &config, const Graph &G,
+                                     vector<PartitionID> &clustering)
+{
+    if (config.lm_objective == CPM_OBJECTIVE)
+    {
+        return ObjectiveMetric<ConstantPottsObjective, Graph>(G, clustering, ConstantPottsObjective(config.lm_resolution)).quality();
+    }
+    else if (config.lm_resolution != 1.0)
+    {
+        return ObjectiveMetric<ResolutionModularityObjective, Graph>(G, clustering, ResolutionModularityObjective(config.lm_resolution)).quality();
+    }
+
+    return ObjectiveMetric<ModularityObjective, Graph>(G, clustering, ModularityObjective()).quality();
+}
+
+
+bool LouvainMethod::guardCoarseningWithSCLP(const PartitionConfig &config, const ClusteringGraph &G,
+                                            vector<PartitionID> &clustering)
+{
+    LevelStatistics level = { G.number_of_nodes(), countClusters(clustering), false, true };
+
+    if (isLowShrink(config, level.numberOfNodes, level.numberOfClusters)
+        && config.lm_low_shrink_action == LABEL_PROPAGATION_LOWSHRINK)
+    {
+        // size constrained label propagation from singletons as stronger aggregator
+        NodeID no_blocks = 0;
+        std::vector< NodeID > cluster_id;
+        size_constraint_label_propagation sclp;
+
+        sclp.label_propagation(config, *m_G, cluster_id, no_blocks);
+
+        vector<PartitionID> aggregated(cluster_id.begin(), cluster_id.end());
+
+        // it ignores the objective, so it may not make the quality worse
+        if (!isLowShrink(config, level.numberOfNodes, no_blocks)
+            && computeQuality(config, G, aggregated) >= computeQuality(config, G, clustering))
+        {
+            clustering.swap(aggregated);
+            level.numberOfClusters = no_blocks;
+            level.labelPropagation = true;
+        }
+    }
+
+    level.contracted = !isLowShrink(config, level.numberOfNodes, level.numberOfClusters);
+    m_levelStatistics.push_back(level);
+
+    return level.contracted;
+}
+
+
+template <typename Graph>
+bool LouvainMethod::guardCoarsening(const PartitionConfig &config, const Graph &G,
+                                    vector<PartitionID> &clustering)
+{
+    LevelStatistics level = { G.number_of_nodes(), countClusters(clustering), false, true };
+
+    if (isLowShrink(config, level.numberOfNodes, level.numberOfClusters)
+        && config.lm_low_shrink_action == LABEL_PROPAGATION_LOWSHRINK)
+    {
+        // label propagation continues from the Louvain clustering and merges its clusters
+        vector<PartitionID> aggregated(clustering);
+
+        LabelPropagation::performLabelPropagation(config, G, aggregated);
+
+        NodeID numberOfClusters = countClusters(aggregated);
+
+        // it ignores the objective, so it may not make the quality worse
+        if (!isLowShrink(config, level.numberOfNodes, numberOfClusters)
+            && computeQuality(config, G, aggregated) >= computeQuality(config, G, clustering))
+        {
+            clustering.swap(aggregated);
+            level.numberOfClusters = numberOfClusters;
+            level.labelPropagation = true;
+        }
+    }
+
+    level.contracted = !isLowShrink(config, level.numberOfNodes, level.numberOfClusters);
+    m_levelStatistics.push_back(level);
+
+    return level.contracted;
+}
+
+
+void LouvainMethod::printLevelStatistics(ostream &out) const
+{
+    for (NodeID i = 0; i < m_levelStatistics.size(); ++i)
+    {
+        const LevelStatistics &level = m_levelStatistics[i];
+
+        out << "level " << i << ": " << level.numberOfNodes << " -> " << level.numberOfClusters
+            << " nodes, shrink factor " << static_cast<double>(level.numberOfNodes) / level.numberOfClusters
+            << (level.labelPropagation ? ", label propagation" : ", louvain")
+            << (level.contracted ? "" : ", not contracted (shrinks too little)") << endl;
+    }
+}
+
+
+template <typename Graph>
+void LouvainMethod::initializeSingletonClusters(const Graph &G, vector<PartitionID> &clustering)
+{
+    clustering.resize(G.number_of_nodes());
+
+    forall_nodes(G, node)
+    {
+        clustering[node] = node;
+    } endfor
+}
+
+
+template <typename Graph>
+NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config,
+                                       const Graph &G,
+                                       vector<PartitionID> &clustering)
+{
+    // create objective object that internally keeps track of
+    // the current clustering in the current graph
+    if (config.lm_objective == CPM_OBJECTIVE)
+    {
+        ObjectiveMetric<ConstantPottsObjective, Graph> objective(G, clustering, ConstantPottsObjective(config.lm_resolution));
+        return performNodeMoves(config, G, clustering, objective);
+    }
+    else if (config.lm_resolution != 1.0)
+    {
+        ObjectiveMetric<ResolutionModularityObjective, Graph> objective(G, clustering, ResolutionModularityObjective(config.lm_resolution));
+        return performNodeMoves(config, G, clustering, objective);
+    }
+
+    ObjectiveMetric<ModularityObjective, Graph> objective(G, clustering, ModularityObjective());
+    return performNodeMoves(config, G, clustering, objective);
+}
+
+
+template <typename Objective, typename Graph>
+NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config,
+                                       const Graph &G,
+                                       vector<PartitionID> &clustering,
+                                       ObjectiveMetric<Objective, Graph> &objective)
+{
+    // usually only the input graph has unit node weights
+    if (G.hasUnitNodeWeights())
+    {
+        return moveNodes<Objective, true>(config, G, clustering, objective);
+    }
+
+    return moveNodes<Objective, false>(config, G, clustering, objective);
+}
+
+
+NodeID LouvainMethod::performFMRefinement(const PartitionConfig &config, const ClusteringGraph &G,
+                                          vector<PartitionID> &clustering)
+{
+    NodeID numberOfMoves = 0;
+    FMRefinement fmRefinement;
+
+    if (config.lm_objective == CPM_OBJECTIVE)
+    {
+        ObjectiveMetric<ConstantPottsObjective> objective(G, clustering, ConstantPottsObjective(config.lm_resolution));
+        numberOfMoves = fmRefinement.refine(config, G, clustering, objective);
+    }
+    else if (config.lm_resolution != 1.0)
+    {
+        ObjectiveMetric<ResolutionModularityObjective> objective(G, clustering, ResolutionModularityObjective(config.lm_resolution));
+        numberOfMoves = fmRefinement.refine(config, G, clustering, objective);
+    }
+    else
+    {
+        ObjectiveMetric<ModularityObjective> objective(G, clustering, ModularityObjective());
+        numberOfMoves = fmRefinement.refine(config, G, clustering, objective);
+    }
+
+    return numberOfMoves;
+}
+
+
+template <typename Objective, bool UnitNodeWeights, typename Graph>
+NodeID LouvainMethod::moveNodes(const PartitionConfig &config,
+                                const Graph &G,
+                                vector<PartitionID> &clustering,
+                                ObjectiveMetric<Objective, Graph> &objective)
 {
     /// normally modularity should be in the range [-1,1]
     double currentQuality = -2.0;
@@ -219,19 +766,17 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
     vector<NodeID> permutation;
     /// number of node moves between clusters
     NodeID numberOfMoves = 0;
-    /// objective function to optimize/maximize
-    /// calculates modularity and keeps track of the clustering,
-    /// could be replaced by any other objective
-    ModularityMetric *objective = 0;
     /// TRUE, if graph has self loops
-    bool hasGraphSelfLoops = m_G->containsSelfLoops();
+    bool hasGraphSelfLoops = G.containsSelfLoops();
     /// info about neighboring clusters of the currently traversed node
     Neighborhood neighborhood;
+    /// TRUE in the first sweep over the nodes
+    bool firstSweep = true;
     /// for measuring time
     timer timer;
 
     // the permutation vector may not be larger than the number of nodes
-    permutation.resize(m_G->number_of_nodes());
+    permutation.resize(G.number_of_nodes());
     // initialize with increasing values starting with zero: 0, 1, 2, 3, 4...
     // but nodesOrder.order_nodes() does the same
     // iota(permutation.begin(), permutation.end(), 0);
@@ -241,7 +786,14 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
     // in the outer loop and not every time in the inner one
     // nodesOrder.order_nodes(config, *m_G, permutation);
 
-    random_functions::permutate_vector_good( permutation, true);
+    if (config.lm_visit_block_edges > 0)
+    {
+        VisitOrder::blockPermutation(G, config.lm_visit_block_edges, permutation);
+    }
+    else
+    {
+        random_functions::permutate_vector_good( permutation, true);
+    }
     //std::iota(permutation.begin(), permutation.end(), 0);
     //for(size_t i = 0; i < permutation.size(); ++i) {
         //size_t pos = rand() % (permutation.size() - i) + i;
@@ -249,12 +801,10 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
     //}
 
     // set neighborhood data structures
-    neighborhood.initialize(m_G);
+    neighborhood.initialize(&G, &clustering);
+    neighborhood.initializeHeavyNodes(config.lm_heavy_node_degree, config.lm_heavy_node_sample);
 
-    // create modularity object that internally keeps track of
-    // the current clustering in the current graph
-    objective = new ModularityMetric(*m_G);
-    currentQuality = objective->quality();
+    currentQuality = objective.quality();
 
 
     // phase 1: maximize modularity by assigning nodes to new clusters
@@ -277,16 +827,22 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
 
         oldQuality = currentQuality;
 
+        // heavy nodes rate only a sample of their edges in the first sweep
+        neighborhood.setSampling(firstSweep);
+        firstSweep = false;
+
         // fill and permute the node order
         // maybe it would be sufficient to permute only once
         // in the outer loop and not every time here in the inner one
         // nodesOrder.order_nodes(config, *m_G, permutation);
 
         // traverse nodes in random order
-        forall_nodes((*m_G), nn)
+        forall_nodes(G, nn)
         {
             NodeID node = permutation[nn];
 
+            VisitOrder::prefetchAhead(G, permutation, nn);
+
             // computation of neighboring clusters
             neighborhood.update(node);
 
@@ -294,38 +850,51 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
             // other clusters too
             if (neighborhood.getNumberOfNeighboringClusters() > 1)
             {
-                PartitionID oldCluster = m_G->getPartitionIndex(node);
+                PartitionID oldCluster = clustering[node];
                 PartitionID bestCluster = oldCluster;
-                double bestGain = 0.0;
                 EdgeWeight selfLoop = 0;
+                EdgeWeight nodeVolume = objective.template nodeVolume<UnitNodeWeights>(node);
 
                 if (hasGraphSelfLoops)
                 {
-                    selfLoop = m_G->getSelfLoop(node);
+                    selfLoop = G.getSelfLoop(node);
                 }
 
+                // the objective needs the exact edge weights,
+                // a sampled neighborhood has only estimates
+                EdgeWeight edgeWeightToOldCluster = neighborhood.isSampled()
+                                                    ? neighborhood.computeEdgeWeightToCluster(node, oldCluster)
+                                                    : neighborhood.getEdgeWeightToNeighboringCluster(oldCluster);
+
                 // remove the current node from its cluster
-                objective->removeNode(node, oldCluster, neighborhood.getEdgeWeightToNeighboringCluster(oldCluster), selfLoop);
+                objective.removeNode(node, nodeVolume, oldCluster, edgeWeightToOldCluster, selfLoop);
 
                 // find best cluster in the neighborhood
                 // as we have already calculated the neighboring clusters
-                // we just iterate over them and not over all out edges
-                for (NodeID i = 0; i < neighborhood.getNumberOfNeighboringClusters(); ++i)
+                // we just evaluate them at once and not iterate over all out edges
+                int bestNeighbor = objective.findBestNeighbor(nodeVolume,
+                                                              neighborhood.getClusterIDsOfNeighbors(),
+                                                              neighborhood.getEdgeWeightsToNeighbors(),
+                                                              neighborhood.getNumberOfNeighboringClusters(),
+                                                              config.lm_exact_gains);
+
+                if (bestNeighbor >= 0)
+                {
+                    bestCluster = neighborhood.getClusterIDOfNeighbor(bestNeighbor);
+                }
+
+                EdgeWeight edgeWeightToBestCluster = edgeWeightToOldCluster;
+
+                if (bestCluster != oldCluster)
                 {
-                    PartitionID newCluster = neighborhood.getClusterIDOfNeighbor(i);
-                    // the gain is not normalized, it is not the real improvement
-                    double gain = objective->gain(node, newCluster, neighborhood.getEdgeWeightToNeighboringCluster(newCluster));
-
-                    if (bestGain < gain)
-                    {
-                        bestGain = gain;
-                        bestCluster = newCluster;
-                    }
+                    edgeWeightToBestCluster = neighborhood.isSampled()
+                                              ? neighborhood.computeEdgeWeightToCluster(node, bestCluster)
+                                              : neighborhood.getEdgeWeightToNeighboringCluster(bestCluster);
                 }
 
                 // assign node to best cluster
                 // at least we assign it to the old cluster again
-                objective->insertNode(node, bestCluster, neighborhood.getEdgeWeightToNeighboringCluster(bestCluster), selfLoop);
+                objective.insertNode(node, nodeVolume, bestCluster, edgeWeightToBestCluster, selfLoop);
 
                 if (oldCluster != bestCluster)
                 {
@@ -334,11 +903,9 @@ NodeID LouvainMethod::performNodeMoves(const PartitionConfig &config)
             }
         } endfor
 
-        currentQuality = objective->quality();
+        currentQuality = objective.quality();
     }
     while (currentQuality - oldQuality > config.lm_minimum_quality_improvement);
 
-    delete objective;
-
     return numberOfMoves;
 }
@@ -8,14 +8,23 @@
 #ifndef LOUVAINMETHOD_H
 #define LOUVAINMETHOD_H
 
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include "data_structure/graph_hierarchy.h"
 #include "partition/partition_config.h"
+#include "tools/objectivemetric.h"
+
+#include <list>
+#include <ostream>
+#include <vector>
 
 /**
  *  \brief Represents the "Louvain" clustering algorithm.
  *
- *  Maximizing modularity is used as objective for the clustering.
+ *  Maximizing modularity is used as objective for the clustering, on the
+ *  ClusteringGraph path also modularity with a resolution parameter or the
+ *  constant Potts model (config.lm_objective, config.lm_resolution).
  *  A multi level label propagation can be used as preprocessing to speed up.
  *
  *  The implementation is tailored for weighted integer graphs.
@@ -27,6 +36,21 @@
 class LouvainMethod
 {
     public:
+        /**
+            \brief Shrink statistics of a coarsening level.
+         */
+        struct LevelStatistics
+        {
+            /// Number of nodes of the level.
+            NodeID numberOfNodes;
+            /// Number of clusters (nodes of the next level, if it was contracted).
+            NodeID numberOfClusters;
+            /// TRUE, if the clusters were computed by label propagation.
+            bool labelPropagation;
+            /// FALSE, if the coarsening stopped here because the level shrinks too little.
+            bool contracted;
+        };
+
         LouvainMethod();
         virtual ~LouvainMethod();
 
@@ -87,12 +111,137 @@ class LouvainMethod
          */
         PartitionID performClusteringWithLPP(const PartitionConfig &config,
                                              graph_access *G, bool = true);
+
+
+        /**
+            \brief performClusteringWithLPP() on a CompressedGraph (from singletons).
+
+            The first level (label propagation if config.lm_number_of_label_propagation_levels
+            is set, otherwise Louvain node moves) works on G, its clusters are contracted
+            to a ClusteringGraph and the remaining levels work on that as in
+            performClusteringWithLPP(). The result is refined on G by node moves, without
+            FM refinement. G is not reordered and not changed. Size constrained label
+            propagation is not supported (KaHIP works on graph_access).
+
+            \param clustering [out] Cluster of each node, consecutive IDs.
+
+            \return Number of computed clusters.
+         */
+        PartitionID performClustering(const PartitionConfig &config, const CompressedGraph &G,
+                                      std::vector<PartitionID> &clustering);
+
+
+        /**
+            \brief Refines the clustering of G by node moves (phase 1 of the
+            Louvain method, see performNodeMoves()).
+
+            \param G Graph with a clustering, the cluster IDs have to be smaller
+            than the number of nodes.
+
+            \return Number of node moves.
+         */
+        NodeID performRefinement(const PartitionConfig &config, graph_access *G);
+
+
+        /**
+            \brief Returns the levels of the last performClusteringWithLPP() (also the
+            label propagation levels), finest first.
+         */
+        const std::vector<LevelStatistics> &getLevelStatistics() const { return m_levelStatistics; }
+
+        /**
+            \brief Writes getLevelStatistics() to "out", one line per level.
+         */
+        void printLevelStatistics(std::ostream &out) const;
     protected:
+        /**
+            \brief Returns TRUE, if contracting "numberOfNodes" nodes to "numberOfClusters"
+            shrinks the graph less than config.lm_minimum_shrink_factor.
+         */
+        static bool isLowShrink(const PartitionConfig &config, NodeID numberOfNodes, NodeID numberOfClusters)
+        {
+            return numberOfNodes < config.lm_minimum_shrink_factor * numberOfClusters;
+        }
+
+        /**
+            \brief Returns the quality of "clustering" of a ClusteringGraph or CompressedGraph
+            under the objective of config (computed from scratch).
+         */
+        template <typename Graph>
+        static double computeQuality(const PartitionConfig &config, const Graph &G,
+                                     std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Returns the number of different cluster IDs (smaller than the number of nodes).
+         */
+        static NodeID countClusters(const std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Builds the compact copy G of m_G and reads the clustering of m_G
+            (its partition indices) into "clustering".
+
+            Called once per level on the graph_access path, the node moves, the
+            coarsening guard and the FM refinement of the level share G.
+         */
+        void buildLevel(ClusteringGraph &G, std::vector<PartitionID> &clustering) const;
+
+        /**
+            \brief Writes "clustering" back to the partition indices of m_G.
+         */
+        void storeClustering(const std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Checks the shrink of the clustering of a Louvain level before it is
+            contracted and records the statistics of the level.
+
+            If it shrinks too little and config.lm_low_shrink_action is label propagation,
+            label propagation starting from "clustering" replaces the clustering, if it
+            shrinks enough and does not make the quality worse.
+
+            \return FALSE, if the coarsening stops at this level (the clustering is unchanged).
+         */
+        template <typename Graph>
+        bool guardCoarsening(const PartitionConfig &config, const Graph &G,
+                             std::vector<PartitionID> &clustering);
+
+        /**
+            \brief guardCoarsening() with size constrained label propagation from
+            singletons on m_G, G is the compact copy of m_G (see buildLevel()).
+         */
+        bool guardCoarseningWithSCLP(const PartitionConfig &config, const ClusteringGraph &G,
+                                     std::vector<PartitionID> &clustering);
+
         /**
             \brief Assigns each node to an own cluster.
          */
         void initializeSingletonClusters();
 
+        /**
+            \brief Assigns each node of G (ClusteringGraph or CompressedGraph) to an own cluster.
+         */
+        template <typename Graph>
+        static void initializeSingletonClusters(const Graph &G, std::vector<PartitionID> &clustering);
+
+        /**
+            \brief Renumbers the nodes of G as selected by config.lm_node_reordering.
+
+            G is replaced by the reordered graph and clustering is permuted accordingly.
+
+            \param newID Node v of the old graph is node newID[v] of the new graph.
+
+            \return FALSE, if no reordering is selected (nothing is changed).
+         */
+        static bool reorderNodes(const PartitionConfig &config, ClusteringGraph *&G,
+                                 std::vector<PartitionID> &clustering, std::vector<NodeID> &newID);
+
+        /**
+            \brief Renumbers the nodes of a new coarse graph (see reorderNodes()),
+            the coarse mapping of the finer level is updated to the new IDs.
+         */
+        static void reorderCoarseLevel(const PartitionConfig &config, ClusteringGraph *&coarser,
+                                       std::vector<PartitionID> &coarseMapping,
+                                       std::vector<PartitionID> &clustering);
+
 
         /**
             \brief Computes the number of clusters in the current graph.
@@ -104,7 +253,7 @@ class LouvainMethod
 
         /**
             \brief Moves node between clusters as long there is a minimal
-            quality improvement of the objective (modularity).
+            quality improvement of the objective selected by config.lm_objective.
 
             Phase 1 of the Louvain Algorithm.
             Graph is traversed in random order and nodes are assign to that
@@ -112,19 +261,95 @@ class LouvainMethod
             modularity) as long as there is at least a minimal quality improvement.
             This function can be also used to perform a refinement of a
             given clustering.
-            Graph shall already have (singleton) clusters.
 
             \param config Clustering settings.
-            \param minQualityImprovement Minimum quality gain that is necessary
-            to make another turn and traverse the whole tree and move nodes.
+            \param G ClusteringGraph or CompressedGraph.
+            \param clustering Cluster of each node (IDs smaller than the number of nodes).
 
             \return Number of node moves, total count of all turns.
          */
-        NodeID performNodeMoves(const PartitionConfig &config);
+        template <typename Graph>
+        NodeID performNodeMoves(const PartitionConfig &config,
+                                const Graph &G,
+                                std::vector<PartitionID> &clustering);
+
+
+        /**
+            \brief Same as above with a given objective that keeps track of "clustering" of G.
+
+            Instantiates the kernel for unit or weighted nodes.
+            The objective stays valid afterwards, e.g. for ObjectiveMetric::projectTo().
+         */
+        template <typename Objective, typename Graph>
+        NodeID performNodeMoves(const PartitionConfig &config,
+                                const Graph &G,
+                                std::vector<PartitionID> &clustering,
+                                ObjectiveMetric<Objective, Graph> &objective);
+
+
+        /**
+            \brief Local moving kernel of performNodeMoves().
+         */
+        template <typename Objective, bool UnitNodeWeights, typename Graph>
+        NodeID moveNodes(const PartitionConfig &config,
+                         const Graph &G,
+                         std::vector<PartitionID> &clustering,
+                         ObjectiveMetric<Objective, Graph> &objective);
+
+
+        /**
+            \brief FM refinement (see FMRefinement) of "clustering" of G with the
+            objective selected by config.lm_objective.
+
+            \return Number of node moves that were kept.
+         */
+        NodeID performFMRefinement(const PartitionConfig &config, const ClusteringGraph &G,
+                                   std::vector<PartitionID> &clustering);
+
+
+        /**
+            \brief performClusteringWithLPP() on ClusteringGraphs.
+
+            G is converted once, label propagation, node moves and contraction
+            work on the compact graph. Only the result is written back to G.
+            Not used for size constrained label propagation (KaHIP works on graph_access).
+         */
+        PartitionID performClusteringOnClusteringGraph(const PartitionConfig &config,
+                                                       graph_access *G, bool start_w_singletons);
+
+
+        /**
+            \brief Label propagation levels, Louvain levels and uncoarsening of
+            performClusteringOnClusteringGraph(), starting on G.
+
+            \param G First level, it is deleted afterwards.
+            \param clustering [in/out] Clustering of G.
+            \param numberOfLPLevels Levels of label propagation before the Louvain levels.
+         */
+        void performClusteringOnLevels(const PartitionConfig &config, ClusteringGraph *G,
+                                       std::vector<PartitionID> &clustering,
+                                       bool start_w_singletons, unsigned numberOfLPLevels);
+
+
+        /**
+            \brief Louvain levels and uncoarsening of performClusteringOnClusteringGraph().
+
+            Starts on the coarsest graph of graphHierarchy. The clustering is projected
+            back through all levels (also the label propagation levels) and refined on
+            each. Afterwards only the first graph is left and "clustering" belongs to it.
+         */
+        template <typename Objective>
+        void performLouvainLevels(const PartitionConfig &config,
+                                  std::list<ClusteringGraph *> &graphHierarchy,
+                                  std::list<std::vector<PartitionID> > &coarseMappings,
+                                  std::vector<PartitionID> &clustering,
+                                  bool start_w_singletons, const Objective &objectivePolicy);
 
 
         /// Current graph that is evaluated.
         graph_access *m_G;
+        /// Statistics of the levels of the last clustering.
+        std::vector<LevelStatistics> m_levelStatistics;
     private:
 };
 
@@ -9,7 +9,7 @@
 using namespace std;
 
 Neighborhood::Neighborhood()
-    : m_G(0), m_numberOfNeighboringClusters(0)
+    : m_G(0), m_leanG(0), m_compressedG(0), m_clustering(0), m_numberOfNeighboringClusters(0), m_sampled(false)
 {
     //ctor
 }
@@ -25,31 +25,133 @@ void Neighborhood::initialize(graph_access* G)
 {
     // update the graph we are working on
     m_G = G;
+    m_leanG = 0;
+    m_compressedG = 0;
+    m_clustering = 0;
 
     // in the worst case a node has edges to all other nodes
     // this is also the maximum number of clusters
     // resize() is not enough, because we also want to have
-    // -1 as content
-    m_edgeWeightsToNeighboringClusters.assign(m_G->get_partition_count_compute(), -1);
+    // UNDEFINED_NODE as content
+    m_positionsOfNeighboringClusters.assign(m_G->get_partition_count_compute(), UNDEFINED_NODE);
     // here the old content may remain,
     // because new content is set explicitly
     m_clusterIDsOfNeighbors.resize(m_G->get_partition_count_compute(), -1);
+    m_edgeWeightsToNeighbors.resize(m_G->get_partition_count_compute(), 0);
     m_numberOfNeighboringClusters = 0;
 }
 
 
+void Neighborhood::initialize(const ClusteringGraph* G, const std::vector<PartitionID>* clustering)
+{
+    m_G = 0;
+    m_leanG = G;
+    m_compressedG = 0;
+    m_clustering = clustering;
+
+    // cluster IDs are smaller than the number of nodes
+    m_positionsOfNeighboringClusters.assign(m_leanG->number_of_nodes(), UNDEFINED_NODE);
+    m_clusterIDsOfNeighbors.resize(m_leanG->number_of_nodes(), -1);
+    m_edgeWeightsToNeighbors.resize(m_leanG->number_of_nodes(), 0);
+    m_numberOfNeighboringClusters = 0;
+}
+
+
+void Neighborhood::initialize(const CompressedGraph* G, const std::vector<PartitionID>* clustering)
+{
+    m_G = 0;
+    m_leanG = 0;
+    m_compressedG = G;
+    m_clustering = clustering;
+
+    m_positionsOfNeighboringClusters.assign(m_compressedG->number_of_nodes(), UNDEFINED_NODE);
+    m_clusterIDsOfNeighbors.resize(m_compressedG->number_of_nodes(), -1);
+    m_edgeWeightsToNeighbors.resize(m_compressedG->number_of_nodes(), 0);
+    m_numberOfNeighboringClusters = 0;
+}
+
+
+void Neighborhood::initializeHeavyNodes(NodeID degreeThreshold, NodeID sampleSize)
+{
+    m_heavyNodes.initialize(degreeThreshold, sampleSize);
+}
+
+
+EdgeWeight Neighborhood::computeEdgeWeightToCluster(NodeID node, PartitionID cluster) const
+{
+    if (m_leanG)
+    {
+        return computeEdgeWeightToCluster(*m_leanG, node, cluster);
+    }
+
+    return computeEdgeWeightToCluster(*m_compressedG, node, cluster);
+}
+
+
+template <typename Graph>
+EdgeWeight Neighborhood::computeEdgeWeightToCluster(const Graph &G, NodeID node, PartitionID cluster) const
+{
+    const vector<PartitionID> &clustering = *m_clustering;
+    EdgeWeight edgeWeight = 0;
+
+    if (G.hasUnitEdgeWeights())
+    {
+        forall_neighbors(G, node, target, weight, true)
+        {
+            edgeWeight += clustering[target] == cluster ? weight : 0;
+        } endfor
+    }
+    else
+    {
+        forall_neighbors(G, node, target, weight, false)
+        {
+            edgeWeight += clustering[target] == cluster ? weight : 0;
+        } endfor
+    }
+
+    return edgeWeight;
+}
+
+
 void Neighborhood::update(NodeID node)
 {
+    if (m_leanG)
+    {
+        if (m_leanG->hasUnitEdgeWeights())
+        {
+            updateLean<true>(*m_leanG, node);
+        }
+        else
+        {
+            updateLean<false>(*m_leanG, node);
+        }
+        return;
+    }
+
+    if (m_compressedG)
+    {
+        if (m_compressedG->hasUnitEdgeWeights())
+        {
+            updateLean<true>(*m_compressedG, node);
+        }
+        else
+        {
+            updateLean<false>(*m_compressedG, node);
+        }
+        return;
+    }
+
     // reset the neighborhood of the previous node
     for (vector<EdgeWeight>::size_type i = 0; i < m_numberOfNeighboringClusters; ++i)
     {
-        m_edgeWeightsToNeighboringClusters[m_clusterIDsOfNeighbors[i]] = -1;
+        m_positionsOfNeighboringClusters[m_clusterIDsOfNeighbors[i]] = UNDEFINED_NODE;
     }
     m_numberOfNeighboringClusters = 0;
 
     // we also have to store the info about the node itself
     m_clusterIDsOfNeighbors[0] = m_G->getPartitionIndex(node);
-    m_edgeWeightsToNeighboringClusters[m_clusterIDsOfNeighbors[0]] = 0;
+    m_edgeWeightsToNeighbors[0] = 0;
+    m_positionsOfNeighboringClusters[m_clusterIDsOfNeighbors[0]] = 0;
     m_numberOfNeighboringClusters++;
 
     // we count the cluster sizes in the neighborhood
@@ -59,16 +161,61 @@ void Neighborhood::update(NodeID node)
         PartitionID clusterIDOfNeighbor = m_G->getPartitionIndex(neighboringNode);
         EdgeWeight weightToNeighbor = m_G->getEdgeWeight(e);
 
+        NodeID position = m_positionsOfNeighboringClusters.at(clusterIDOfNeighbor);
+
         // is this the first neighbor with such a cluster ID?
-        //if (m_edgeWeightsToNeighboringClusters[clusterIDOfNeighbor] == -1)
-        if (m_edgeWeightsToNeighboringClusters.at(clusterIDOfNeighbor) == -1)
+        if (position == UNDEFINED_NODE)
         {
-            m_edgeWeightsToNeighboringClusters[clusterIDOfNeighbor] = 0;
-            m_clusterIDsOfNeighbors[m_numberOfNeighboringClusters] = clusterIDOfNeighbor;
+            position = m_numberOfNeighboringClusters;
+            m_positionsOfNeighboringClusters[clusterIDOfNeighbor] = position;
+            m_clusterIDsOfNeighbors[position] = clusterIDOfNeighbor;
+            m_edgeWeightsToNeighbors[position] = 0;
             m_numberOfNeighboringClusters++;
         }
 
-        m_edgeWeightsToNeighboringClusters[clusterIDOfNeighbor] += weightToNeighbor;
+        m_edgeWeightsToNeighbors[position] += weightToNeighbor;
+    }
+    endfor
+}
+
+
+template <bool UnitEdgeWeights, typename Graph>
+void Neighborhood::updateLean(const Graph &G, NodeID node)
+{
+    const vector<PartitionID> &clustering = *m_clustering;
+
+    // reset the neighborhood of the previous node
+    for (vector<EdgeWeight>::size_type i = 0; i < m_numberOfNeighboringClusters; ++i)
+    {
+        m_positionsOfNeighboringClusters[m_clusterIDsOfNeighbors[i]] = UNDEFINED_NODE;
+    }
+    m_numberOfNeighboringClusters = 0;
+
+    // we also have to store the info about the node itself
+    m_clusterIDsOfNeighbors[0] = clustering[node];
+    m_edgeWeightsToNeighbors[0] = 0;
+    m_positionsOfNeighboringClusters[m_clusterIDsOfNeighbors[0]] = 0;
+    m_numberOfNeighboringClusters++;
+    m_sampled = false;
+
+    // heavy nodes: the clusters come already aggregated, in the same order
+    if (m_heavyNodes.isHeavy(G, node))
+    {
+        NodeID count = m_heavyNodes.aggregate<UnitEdgeWeights>(G, node, clustering);
+        const PartitionID *clusters = m_heavyNodes.getClusters();
+        const EdgeWeight *edgeWeights = m_heavyNodes.getEdgeWeights();
+
+        for (NodeID i = 0; i < count; ++i)
+        {
+            addEdgeWeightToCluster(clusters[i], edgeWeights[i]);
+        }
+        m_sampled = m_heavyNodes.wasSampled();
+        return;
+    }
+
+    forall_neighbors(G, node, target, weight, UnitEdgeWeights)
+    {
+        addEdgeWeightToCluster(clustering[target], weight);
     }
     endfor
 }
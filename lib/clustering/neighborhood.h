@@ -8,6 +8,9 @@
 #ifndef NEIGHBORHOOD_H
 #define NEIGHBORHOOD_H
 
+#include "clustering/heavynodes.h"
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include <vector>
 
@@ -30,6 +33,43 @@ class Neighborhood
          */
         void initialize(graph_access *G);
 
+        /**
+            \brief Resets the neighborhood data structures for a ClusteringGraph.
+
+            \param G The new current graph we use.
+            \param clustering Cluster of each node of G (IDs smaller than the number of nodes).
+         */
+        void initialize(const ClusteringGraph *G, const std::vector<PartitionID> *clustering);
+
+        /**
+            \brief Resets the neighborhood data structures for a CompressedGraph.
+
+            Same as above.
+         */
+        void initialize(const CompressedGraph *G, const std::vector<PartitionID> *clustering);
+
+        /**
+            \brief Handling of heavy nodes of a ClusteringGraph or CompressedGraph (see HeavyNodeAggregation).
+
+            \param degreeThreshold Nodes with more out edges are aggregated in parallel
+            chunks, 0 disables it.
+            \param sampleSize If non-zero, heavy nodes rate only about this many edges
+            while sampling is enabled (see setSampling()).
+         */
+        void initializeHeavyNodes(NodeID degreeThreshold, NodeID sampleSize);
+
+        /// Enables or disables the sampling of the edges of heavy nodes.
+        void setSampling(bool sampling) { m_heavyNodes.setSampling(sampling); }
+
+        /// Returns TRUE, if the last update() sampled the edges, then the edge weights are estimates.
+        bool isSampled() const { return m_sampled; }
+
+        /**
+            \brief Returns the exact edge weight from "node" to "cluster" of a
+            ClusteringGraph or CompressedGraph, by a scan of the out edges (for sampled neighborhoods).
+         */
+        EdgeWeight computeEdgeWeightToCluster(NodeID node, PartitionID cluster) const;
+
 
         /**
             \brief Computes the edge weights to the local clusters
@@ -44,18 +84,54 @@ class Neighborhood
         EdgeWeight getEdgeWeightToNeighboringCluster(PartitionID cluster) const;
         /// Returns the cluster ID of "neighbor".
         PartitionID getClusterIDOfNeighbor(NodeID neighbor) const;
+        /// Returns the edge weight to the "neighbor"-th cluster in the neighborhood.
+        EdgeWeight getEdgeWeightToNeighbor(NodeID neighbor) const;
         /// Returns the number of clusters in the current neighborhood.
         std::vector<EdgeWeight>::size_type getNumberOfNeighboringClusters() const;
+        /// Cluster IDs of the neighborhood, contiguous (getNumberOfNeighboringClusters() entries).
+        const PartitionID *getClusterIDsOfNeighbors() const { return &m_clusterIDsOfNeighbors[0]; }
+        /// Edge weights to the clusters of getClusterIDsOfNeighbors(), contiguous.
+        const EdgeWeight *getEdgeWeightsToNeighbors() const { return &m_edgeWeightsToNeighbors[0]; }
 
     protected:
+        /**
+            \brief update() for a ClusteringGraph or CompressedGraph.
+         */
+        template <bool UnitEdgeWeights, typename Graph>
+        void updateLean(const Graph &G, NodeID node);
+
+        /**
+            \brief computeEdgeWeightToCluster() for a ClusteringGraph or CompressedGraph.
+         */
+        template <typename Graph>
+        EdgeWeight computeEdgeWeightToCluster(const Graph &G, NodeID node, PartitionID cluster) const;
+
+        /**
+            \brief Adds "weight" to the edge weight to "cluster", appends "cluster"
+            if it is not in the neighborhood yet.
+         */
+        void addEdgeWeightToCluster(PartitionID cluster, EdgeWeight weight);
+
         /// Current graph that is evaluated.
         graph_access *m_G;
-        /// Edge weights to the clusters in the neighborhood of the current node.
-        std::vector<EdgeWeight> m_edgeWeightsToNeighboringClusters;
+        /// Current graph, if we work on a ClusteringGraph (then m_G is 0).
+        const ClusteringGraph *m_leanG;
+        /// Current graph, if we work on a CompressedGraph (then m_G and m_leanG are 0).
+        const CompressedGraph *m_compressedG;
+        /// Clustering of m_leanG or m_compressedG.
+        const std::vector<PartitionID> *m_clustering;
+        /// Position of each cluster in m_clusterIDsOfNeighbors, UNDEFINED_NODE if it is not in the neighborhood.
+        std::vector<NodeID> m_positionsOfNeighboringClusters;
         /// Occurring cluster IDs in the neighborhood of the current node.
         std::vector<PartitionID> m_clusterIDsOfNeighbors;
+        /// Edge weights to the clusters in m_clusterIDsOfNeighbors.
+        std::vector<EdgeWeight> m_edgeWeightsToNeighbors;
         /// Cluster count in the neighborhood of the current node.
         std::vector<EdgeWeight>::size_type m_numberOfNeighboringClusters;
+        /// Aggregation of the out edges of heavy nodes.
+        HeavyNodeAggregation m_heavyNodes;
+        /// TRUE, if the current neighborhood was computed from a sample of the edges.
+        bool m_sampled;
 
     private:
 };
@@ -64,13 +140,41 @@ class Neighborhood
 inline EdgeWeight Neighborhood::getEdgeWeightToNeighboringCluster(PartitionID cluster) const
 {
 #ifdef NDEBUG
-    return m_edgeWeightsToNeighboringClusters[cluster];
+    return m_edgeWeightsToNeighbors[m_positionsOfNeighboringClusters[cluster]];
 #else
-    return m_edgeWeightsToNeighboringClusters.at(cluster);
+    return m_edgeWeightsToNeighbors.at(m_positionsOfNeighboringClusters.at(cluster));
 #endif // NDEBUG
 }
 
 
+inline EdgeWeight Neighborhood::getEdgeWeightToNeighbor(NodeID neighbor) const
+{
+#ifdef NDEBUG
+    return m_edgeWeightsToNeighbors[neighbor];
+#else
+    return m_edgeWeightsToNeighbors.at(neighbor);
+#endif // NDEBUG
+}
+
+
+inline void Neighborhood::addEdgeWeightToCluster(PartitionID cluster, EdgeWeight weight)
+{
+    NodeID position = m_positionsOfNeighboringClusters[cluster];
+
+    // is this the first neighbor with such a cluster ID?
+    if (position == UNDEFINED_NODE)
+    {
+        position = m_numberOfNeighboringClusters;
+        m_positionsOfNeighboringClusters[cluster] = position;
+        m_clusterIDsOfNeighbors[position] = cluster;
+        m_edgeWeightsToNeighbors[position] = 0;
+        m_numberOfNeighboringClusters++;
+    }
+
+    m_edgeWeightsToNeighbors[position] += weight;
+}
+
+
 inline PartitionID Neighborhood::getClusterIDOfNeighbor(NodeID neighbor) const
 {
 #ifdef NDEBUG
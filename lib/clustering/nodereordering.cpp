@@ -0,0 +1,232 @@
+/******************************************************************************
+ * nodereordering.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "nodereordering.h"
+
+#include "clustering/labelpropagation.h"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+bool NodeReordering::computeOrdering(const PartitionConfig &config,
+                                     const ClusteringGraph &G,
+                                     const vector<PartitionID> &clustering,
+                                     vector<NodeID> &newID)
+{
+    switch (config.lm_node_reordering)
+    {
+        case DEGREE_NODEREORDERING:
+            degreeOrdering(G, newID);
+            return true;
+        case BFS_NODEREORDERING:
+            bfsOrdering(G, newID, false);
+            return true;
+        case RCM_NODEREORDERING:
+            bfsOrdering(G, newID, true);
+            return true;
+        case CLUSTER_NODEREORDERING:
+        {
+            // a round of label propagation groups densely connected nodes,
+            // the given clustering itself is not changed
+            vector<PartitionID> localClustering(clustering);
+            PartitionConfig lpConfig = config;
+            lpConfig.lm_number_of_label_propagation_iterations = 1;
+
+            LabelPropagation::performLabelPropagation(lpConfig, G, localClustering);
+            clusterOrdering(G, localClustering, newID);
+            return true;
+        }
+        case NO_NODEREORDERING:
+        default:
+            return false;
+    }
+}
+
+
+void NodeReordering::degreeOrdering(const ClusteringGraph &G, vector<NodeID> &newID)
+{
+    vector<NodeID> order(G.number_of_nodes());
+
+    forall_nodes(G, node)
+    {
+        order[node] = node;
+    } endfor
+
+    stable_sort(order.begin(), order.end(),
+                [&](const NodeID &lhs, const NodeID &rhs) -> bool {
+                    return G.getNodeDegree(lhs) > G.getNodeDegree(rhs);
+                });
+
+    newID.resize(G.number_of_nodes());
+    for (NodeID i = 0; i < order.size(); ++i)
+    {
+        newID[order[i]] = i;
+    }
+}
+
+
+void NodeReordering::bfsOrdering(const ClusteringGraph &G, vector<NodeID> &newID,
+                                 bool reverseCuthillMcKee)
+{
+    NodeID n = G.number_of_nodes();
+    /// nodes in the order the searches visit them, also used as queue
+    vector<NodeID> order;
+    /// start nodes of the searches (by increasing degree for RCM)
+    vector<NodeID> starts(n);
+    /// neighbors of the current node sorted by degree (RCM)
+    vector<NodeID> neighbors;
+
+    newID.assign(n, UNDEFINED_NODE);
+    order.reserve(n);
+
+    forall_nodes(G, node)
+    {
+        starts[node] = node;
+    } endfor
+
+    if (reverseCuthillMcKee)
+    {
+        stable_sort(starts.begin(), starts.end(),
+                    [&](const NodeID &lhs, const NodeID &rhs) -> bool {
+                        return G.getNodeDegree(lhs) < G.getNodeDegree(rhs);
+                    });
+    }
+
+    for (NodeID s = 0; s < n; ++s)
+    {
+        NodeID start = starts[s];
+
+        if (newID[start] != UNDEFINED_NODE)
+        {
+            continue;
+        }
+
+        // newID is used as "visited" marker during the search
+        NodeID head = order.size();
+        newID[start] = head;
+        order.push_back(start);
+
+        while (head < order.size())
+        {
+            NodeID node = order[head++];
+
+            neighbors.clear();
+            forall_out_edges(G, e, node)
+            {
+                NodeID target = G.getEdgeTarget(e);
+
+                if (newID[target] == UNDEFINED_NODE)
+                {
+                    newID[target] = 0;
+                    neighbors.push_back(target);
+                }
+            } endfor
+
+            if (reverseCuthillMcKee)
+            {
+                stable_sort(neighbors.begin(), neighbors.end(),
+                            [&](const NodeID &lhs, const NodeID &rhs) -> bool {
+                                return G.getNodeDegree(lhs) < G.getNodeDegree(rhs);
+                            });
+            }
+
+            for (NodeID i = 0; i < neighbors.size(); ++i)
+            {
+                newID[neighbors[i]] = order.size();
+                order.push_back(neighbors[i]);
+            }
+        }
+    }
+
+    if (reverseCuthillMcKee)
+    {
+        for (NodeID i = 0; i < n; ++i)
+        {
+            newID[order[i]] = n - 1 - i;
+        }
+    }
+}
+
+
+void NodeReordering::clusterOrdering(const ClusteringGraph &G,
+                                     const vector<PartitionID> &clustering,
+                                     vector<NodeID> &newID)
+{
+    NodeID n = G.number_of_nodes();
+    /// clusters renumbered by first occurrence
+    vector<PartitionID> clusterID(n, UNDEFINED_NODE);
+    /// first new node ID of each cluster (counting sort)
+    vector<NodeID> clusterStart;
+
+    forall_nodes(G, node)
+    {
+        PartitionID &cluster = clusterID[clustering[node]];
+
+        if (cluster == UNDEFINED_NODE)
+        {
+            cluster = clusterStart.size();
+            clusterStart.push_back(0);
+        }
+        clusterStart[cluster]++;
+    } endfor
+
+    NodeID sum = 0;
+    for (PartitionID c = 0; c < clusterStart.size(); ++c)
+    {
+        NodeID size = clusterStart[c];
+        clusterStart[c] = sum;
+        sum += size;
+    }
+
+    newID.resize(n);
+    forall_nodes(G, node)
+    {
+        newID[node] = clusterStart[clusterID[clustering[node]]]++;
+    } endfor
+}
+
+
+void NodeReordering::reorder(const ClusteringGraph &G, const vector<NodeID> &newID,
+                             ClusteringGraph &reordered)
+{
+    NodeID n = G.number_of_nodes();
+    /// inverse of newID
+    vector<NodeID> oldID(n);
+    /// out edges of the current node (new target, weight)
+    vector<pair<NodeID, EdgeWeight> > edges;
+
+    forall_nodes(G, node)
+    {
+        oldID[newID[node]] = node;
+    } endfor
+
+    reordered.startConstruction(n, G.number_of_edges(), G.hasUnitEdgeWeights());
+
+    for (NodeID newNode = 0; newNode < n; ++newNode)
+    {
+        NodeID node = oldID[newNode];
+
+        edges.clear();
+        forall_out_edges(G, e, node)
+        {
+            edges.push_back(make_pair(newID[G.getEdgeTarget(e)], G.getEdgeWeight(e)));
+        } endfor
+
+        sort(edges.begin(), edges.end());
+
+        for (EdgeID i = 0; i < edges.size(); ++i)
+        {
+            reordered.newEdge(edges[i].first, edges[i].second);
+        }
+
+        reordered.finishNode(G.getNodeWeight(node), G.getSelfLoop(node));
+    }
+
+    reordered.finishConstruction();
+}
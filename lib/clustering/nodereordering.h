@@ -0,0 +1,75 @@
+/******************************************************************************
+ * nodereordering.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef NODEREORDERING_H
+#define NODEREORDERING_H
+
+#include "data_structure/clusteringgraph.h"
+#include "partition/partition_config.h"
+
+#include <vector>
+
+
+/**
+ *  \brief Renumbers the nodes of a ClusteringGraph to improve the memory locality
+ *  of the neighbor loops (accesses to the clustering and the cluster volumes).
+ *
+ *  An ordering is given as "newID": node v of the original graph becomes
+ *  node newID[v] of the reordered graph. A clustering of the reordered graph
+ *  is mapped back by clustering[v] = reorderedClustering[newID[v]].
+ */
+class NodeReordering
+{
+    public:
+        /**
+            \brief Computes the ordering selected by config.lm_node_reordering.
+
+            \param clustering Current clustering of G, used as start for the
+            cluster contiguous ordering.
+            \param newID Computed ordering.
+
+            \return FALSE, if no reordering is selected (newID is not set).
+         */
+        static bool computeOrdering(const PartitionConfig &config,
+                                    const ClusteringGraph &G,
+                                    const std::vector<PartitionID> &clustering,
+                                    std::vector<NodeID> &newID);
+
+        /**
+            \brief Nodes sorted by decreasing degree (stable), so the data of
+            the frequently accessed high degree nodes is packed together.
+         */
+        static void degreeOrdering(const ClusteringGraph &G, std::vector<NodeID> &newID);
+
+        /**
+            \brief Nodes in breadth first search order, one search per connected component.
+
+            \param reverseCuthillMcKee TRUE, to start each component at a node of minimum
+            degree, visit the neighbors by increasing degree and reverse the
+            resulting order (RCM). Otherwise the searches start at the smallest
+            unvisited node and use the edge order.
+         */
+        static void bfsOrdering(const ClusteringGraph &G, std::vector<NodeID> &newID,
+                                bool reverseCuthillMcKee);
+
+        /**
+            \brief Nodes of the same cluster get consecutive IDs (clusters in order
+            of first occurrence, nodes of a cluster keep their relative order).
+         */
+        static void clusterOrdering(const ClusteringGraph &G,
+                                    const std::vector<PartitionID> &clustering,
+                                    std::vector<NodeID> &newID);
+
+        /**
+            \brief Builds the graph with renumbered nodes, the out edges of each
+            node are sorted by their new targets.
+         */
+        static void reorder(const ClusteringGraph &G, const std::vector<NodeID> &newID,
+                            ClusteringGraph &reordered);
+};
+
+#endif // NODEREORDERING_H
@@ -0,0 +1,193 @@
+/******************************************************************************
+ * clusteringgraph.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "clusteringgraph.h"
+
+using namespace std;
+
+ClusteringGraph::ClusteringGraph()
+    : m_numberOfNodes(0), m_containsSelfLoops(false), m_unitNodeWeights(true), m_unitEdgeWeights(false)
+{
+    //ctor
+}
+
+
+ClusteringGraph::~ClusteringGraph()
+{
+    //dtor
+}
+
+
+void ClusteringGraph::build(graph_access &G)
+{
+    NodeID n = G.number_of_nodes();
+    EdgeID m = G.number_of_edges();
+
+    m_numberOfNodes = n;
+    m_containsSelfLoops = G.containsSelfLoops();
+    m_unitNodeWeights = true;
+    m_unitEdgeWeights = G.hasUnitEdgeWeights();
+
+    m_offsets.resize(n + 1);
+    m_targets.resize(m);
+    m_edgeWeights.resize(m_unitEdgeWeights ? 0 : m);
+    m_nodeWeights.resize(n);
+    m_selfLoops.assign(n, 0);
+    m_weightedNodeDegrees.resize(n);
+
+    forall_nodes(G, node)
+    {
+        EdgeWeight weightedDegree = 0;
+
+        m_offsets[node] = G.get_first_edge(node);
+        m_nodeWeights[node] = G.getNodeWeight(node);
+        m_unitNodeWeights = m_unitNodeWeights && m_nodeWeights[node] == 1;
+
+        if (m_unitEdgeWeights)
+        {
+            forall_out_edges(G, e, node)
+            {
+                m_targets[e] = G.getEdgeTarget(e);
+            } endfor
+
+            weightedDegree = G.getNodeDegree(node);
+        }
+        else
+        {
+            forall_out_edges(G, e, node)
+            {
+                m_targets[e] = G.getEdgeTarget(e);
+                m_edgeWeights[e] = G.getEdgeWeight(e);
+                weightedDegree += m_edgeWeights[e];
+            } endfor
+        }
+
+        m_weightedNodeDegrees[node] = weightedDegree;
+
+        if (m_containsSelfLoops)
+        {
+            m_selfLoops[node] = G.getSelfLoop(node);
+        }
+    } endfor
+
+    m_offsets[n] = m;
+}
+
+
+void ClusteringGraph::copyTo(graph_access &G) const
+{
+    /// end offset of the empty graph, a default constructed graph has no offsets
+    const EdgeID emptyOffsets[1] = { 0 };
+
+    G.build_from_csr_offsets(m_numberOfNodes, m_numberOfNodes == 0 ? emptyOffsets : m_offsets.data());
+
+    forall_nodes((*this), node)
+    {
+        G.setNodeWeight(node, m_nodeWeights[node]);
+
+        forall_out_edges((*this), e, node)
+        {
+            G.setEdgeTarget(e, m_targets[e]);
+            G.setEdgeWeight(e, getEdgeWeight(e));
+        } endfor
+    } endfor
+
+    G.setUnitEdgeWeights(m_unitEdgeWeights);
+
+    if (m_containsSelfLoops)
+    {
+        G.resizeSelfLoops(m_numberOfNodes);
+
+        forall_nodes((*this), node)
+        {
+            G.setSelfLoop(node, m_selfLoops[node]);
+        } endfor
+    }
+}
+
+
+void ClusteringGraph::startConstruction(NodeID n, EdgeID edgesUpperBound, bool unitEdgeWeights)
+{
+    m_numberOfNodes = 0;
+    m_containsSelfLoops = false;
+    m_unitNodeWeights = true;
+    m_unitEdgeWeights = unitEdgeWeights;
+
+    m_offsets.clear();
+    m_offsets.reserve(n + 1);
+    m_offsets.push_back(0);
+    m_targets.clear();
+    m_targets.reserve(edgesUpperBound);
+    m_edgeWeights.clear();
+    m_edgeWeights.reserve(unitEdgeWeights ? 0 : edgesUpperBound);
+    m_nodeWeights.clear();
+    m_nodeWeights.reserve(n);
+    m_selfLoops.clear();
+    m_selfLoops.reserve(n);
+    m_weightedNodeDegrees.clear();
+    m_weightedNodeDegrees.reserve(n);
+}
+
+
+EdgeID ClusteringGraph::newEdge(NodeID target, EdgeWeight weight)
+{
+    m_targets.push_back(target);
+
+    if (!m_unitEdgeWeights)
+    {
+        m_edgeWeights.push_back(weight);
+    }
+
+    return m_targets.size() - 1;
+}
+
+
+NodeID ClusteringGraph::finishNode(NodeWeight weight, EdgeWeight selfLoop)
+{
+    m_offsets.push_back(m_targets.size());
+    m_nodeWeights.push_back(weight);
+    m_selfLoops.push_back(selfLoop);
+    m_containsSelfLoops = m_containsSelfLoops || selfLoop != 0;
+    m_unitNodeWeights = m_unitNodeWeights && weight == 1;
+
+    return m_numberOfNodes++;
+}
+
+
+void ClusteringGraph::finishConstruction()
+{
+    // the weights may have been changed after newEdge(),
+    // so the weighted degrees are computed at the end
+    m_weightedNodeDegrees.resize(m_numberOfNodes);
+
+    forall_nodes((*this), node)
+    {
+        EdgeWeight weightedDegree = 0;
+
+        forall_out_edges((*this), e, node)
+        {
+            weightedDegree += getEdgeWeight(e);
+        } endfor
+
+        m_weightedNodeDegrees[node] = weightedDegree;
+    } endfor
+
+    // the upper bound of the edges can be much too large
+    AlignedVector<NodeID>::type(m_targets).swap(m_targets);
+    AlignedVector<EdgeWeight>::type(m_edgeWeights).swap(m_edgeWeights);
+}
+
+
+size_t ClusteringGraph::memoryBytes() const
+{
+    return m_offsets.capacity() * sizeof(EdgeID)
+         + m_targets.capacity() * sizeof(NodeID)
+         + m_edgeWeights.capacity() * sizeof(EdgeWeight)
+         + m_nodeWeights.capacity() * sizeof(NodeWeight)
+         + m_selfLoops.capacity() * sizeof(EdgeWeight)
+         + m_weightedNodeDegrees.capacity() * sizeof(EdgeWeight);
+}
@@ -0,0 +1,230 @@
+/******************************************************************************
+ * clusteringgraph.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef CLUSTERINGGRAPH_H
+#define CLUSTERINGGRAPH_H
+
+#include "data_structure/graph_access.h"
+
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+#include <vector>
+
+
+/**
+ *  \brief Allocator that aligns the storage to "Alignment" bytes.
+ */
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+    public:
+        typedef T value_type;
+
+        template <typename U>
+        struct rebind { typedef AlignedAllocator<U, Alignment> other; };
+
+        AlignedAllocator() {}
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+        T *allocate(size_t n)
+        {
+            void *p = 0;
+            if (posix_memalign(&p, Alignment, n * sizeof(T) > 0 ? n * sizeof(T) : Alignment) != 0)
+            {
+                throw std::bad_alloc();
+            }
+            return static_cast<T *>(p);
+        }
+
+        void deallocate(T *p, size_t) { free(p); }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment> &) const { return true; }
+        template <typename U>
+        bool operator!=(const AlignedAllocator<U, Alignment> &) const { return false; }
+};
+
+
+/**
+ *  \brief Compact CSR graph for the clustering path (Louvain, label propagation,
+ *  contraction, modularity).
+ *
+ *  Structure of arrays: offsets, targets, edge weights, node weights,
+ *  self loops and weighted node degrees, each 64 byte aligned.
+ *  A graph with unit edge weights (usually the input graph) has no edge weight
+ *  array, the kernels instantiate getEdgeWeight<true>() for it.
+ *  It has no partition index, the clustering is kept in a separate vector.
+ *  The method names match graph_access, therefore forall_nodes() and
+ *  forall_out_edges() can be used. The kernels that also run on a CompressedGraph
+ *  use forall_neighbors() instead.
+ *
+ *  build() and copyTo() are the adapters from/to graph_access for the KaHIP operators.
+ */
+class ClusteringGraph
+{
+    public:
+        static const size_t ALIGNMENT = 64;
+
+        template <typename T>
+        struct AlignedVector { typedef std::vector<T, AlignedAllocator<T, ALIGNMENT> > type; };
+
+        ClusteringGraph();
+        virtual ~ClusteringGraph();
+
+        /**
+         *  \brief Copies the structure of G (including node weights and self loops).
+         *
+         *  The edge weights are skipped if G has unit edge weights (see graph_access::hasUnitEdgeWeights()).
+         */
+        void build(graph_access &G);
+
+        /**
+         *  \brief Builds G (without partition) from this graph.
+         */
+        void copyTo(graph_access &G) const;
+
+        /**
+         *  \brief Starts the construction, nodes are added in increasing order:
+         *  first the out edges with newEdge(), then finishNode().
+         *
+         *  \param edgesUpperBound Used to reserve memory.
+         *  \param unitEdgeWeights All edge weights are 1, they are not stored.
+         */
+        void startConstruction(NodeID n, EdgeID edgesUpperBound, bool unitEdgeWeights = false);
+        EdgeID newEdge(NodeID target, EdgeWeight weight);
+        NodeID finishNode(NodeWeight weight, EdgeWeight selfLoop);
+        void finishConstruction();
+
+        NodeID number_of_nodes() const { return m_numberOfNodes; }
+        EdgeID number_of_edges() const { return m_targets.size(); }
+
+        EdgeID get_first_edge(NodeID node) const { return m_offsets[node]; }
+        EdgeID get_first_invalid_edge(NodeID node) const { return m_offsets[node + 1]; }
+        EdgeID getNodeDegree(NodeID node) const { return m_offsets[node + 1] - m_offsets[node]; }
+
+        NodeID getEdgeTarget(EdgeID edge) const { return m_targets[edge]; }
+        EdgeWeight getEdgeWeight(EdgeID edge) const { return m_unitEdgeWeights ? 1 : m_edgeWeights[edge]; }
+
+        /**
+         *  \brief getEdgeWeight() for a graph known to have unit (or non-unit) edge weights.
+         */
+        template <bool UnitEdgeWeights>
+        EdgeWeight getEdgeWeight(EdgeID edge) const { return UnitEdgeWeights ? 1 : m_edgeWeights[edge]; }
+
+        /// Only for graphs without unit edge weights.
+        void setEdgeWeight(EdgeID edge, EdgeWeight weight) { m_edgeWeights[edge] = weight; }
+
+        /**
+         *  \brief TRUE, if all edge weights are 1 and not stored.
+         */
+        bool hasUnitEdgeWeights() const { return m_unitEdgeWeights; }
+
+        NodeWeight getNodeWeight(NodeID node) const { return m_nodeWeights[node]; }
+
+        bool containsSelfLoops() const { return m_containsSelfLoops; }
+
+        /**
+         *  \brief TRUE, if all node weights are 1 (usually the input graph).
+         */
+        bool hasUnitNodeWeights() const { return m_unitNodeWeights; }
+        EdgeWeight getSelfLoop(NodeID node) const { return m_selfLoops[node]; }
+
+        /**
+         *  \brief Sum of the weights of the out edges (without the self loop), as
+         *  graph_access::getWeightedNodeDegree() but precomputed.
+         */
+        EdgeWeight getWeightedNodeDegree(NodeID node) const { return m_weightedNodeDegrees[node]; }
+
+        /**
+         *  \brief Hints the CPU to load the first out edges of node into the cache.
+         */
+        void prefetchNeighbors(NodeID node) const
+        {
+            __builtin_prefetch(m_targets.data() + m_offsets[node]);
+            if (!m_unitEdgeWeights)
+            {
+                __builtin_prefetch(m_edgeWeights.data() + m_offsets[node]);
+            }
+        }
+
+        /**
+         *  \brief Bytes used by the graph.
+         */
+        size_t memoryBytes() const;
+
+        /**
+         *  \brief Iterates over the out edges of a single node, see forall_neighbors().
+         *
+         *  With UnitEdgeWeights (only for graphs with unit edge weights) the weight is 1.
+         */
+        template <bool UnitEdgeWeights>
+        class NeighborCursor
+        {
+            public:
+                NeighborCursor(const ClusteringGraph &G, NodeID node)
+                    : m_targets(G.m_targets.data()), m_edgeWeights(G.m_edgeWeights.data()),
+                      m_edge(G.m_offsets[node]), m_end(G.m_offsets[node + 1])
+                {
+                }
+
+                /**
+                 *  \brief Moves to the next out edge, returns FALSE if there is none.
+                 */
+                bool next(NodeID &target, EdgeWeight &weight)
+                {
+                    if (m_edge == m_end)
+                    {
+                        return false;
+                    }
+
+                    target = m_targets[m_edge];
+                    weight = UnitEdgeWeights ? 1 : m_edgeWeights[m_edge];
+                    ++m_edge;
+
+                    return true;
+                }
+
+            private:
+                const NodeID *m_targets;
+                const EdgeWeight *m_edgeWeights;
+                EdgeID m_edge;
+                EdgeID m_end;
+        };
+
+        template <bool UnitEdgeWeights>
+        NeighborCursor<UnitEdgeWeights> neighbors(NodeID node) const
+        {
+            return NeighborCursor<UnitEdgeWeights>(*this, node);
+        }
+
+    protected:
+        NodeID m_numberOfNodes;
+        bool m_containsSelfLoops;
+        bool m_unitNodeWeights;
+        bool m_unitEdgeWeights;
+        /// First out edge of each node (size n+1).
+        AlignedVector<EdgeID>::type m_offsets;
+        AlignedVector<NodeID>::type m_targets;
+        /// Empty if m_unitEdgeWeights.
+        AlignedVector<EdgeWeight>::type m_edgeWeights;
+        AlignedVector<NodeWeight>::type m_nodeWeights;
+        /// Weight of the self loop of each node, 0 if there is none.
+        AlignedVector<EdgeWeight>::type m_selfLoops;
+        AlignedVector<EdgeWeight>::type m_weightedNodeDegrees;
+
+    private:
+};
+
+
+
+// makros - neighbors of a ClusteringGraph or CompressedGraph (the graphs of the clustering kernels)
+// UnitEdgeWeights is a compile time constant, see NeighborCursor
+#define forall_neighbors(G,n,target,weight,UnitEdgeWeights) { auto neighborCursor = (G).template neighbors<UnitEdgeWeights>(n); NodeID target; EdgeWeight weight; while (neighborCursor.next(target, weight)) {
+
+#endif // CLUSTERINGGRAPH_H
@@ -0,0 +1,181 @@
+/******************************************************************************
+ * compressedgraph.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#include "compressedgraph.h"
+
+#include "graph_io.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    /**
+     *  \brief Encodes the nodes of graph_io::readGraphStreamed() into a CompressedGraph.
+     */
+    class CompressedGraphReader : public graph_stream_visitor
+    {
+        public:
+            explicit CompressedGraphReader(CompressedGraph &G) : m_G(G) {}
+
+            void start(NodeID n, EdgeID m, bool weighted)
+            {
+                m_G.startConstruction(n, weighted ? 0 : 1, m);
+            }
+
+            void node(vector<pair<NodeID, EdgeWeight> > &neighbors, NodeWeight weight)
+            {
+                m_G.addNode(neighbors, weight);
+            }
+
+        private:
+            CompressedGraph &m_G;
+    };
+}
+
+
+CompressedGraph::CompressedGraph()
+    : m_numberOfNodes(0), m_numberOfEdges(0), m_uniformEdgeWeight(1), m_uniformNodeWeight(1)
+{
+    //ctor
+}
+
+
+CompressedGraph::~CompressedGraph()
+{
+    //dtor
+}
+
+
+int CompressedGraph::read(const string &filename)
+{
+    CompressedGraphReader reader(*this);
+
+    if (graph_io::readGraphStreamed(filename, reader))
+    {
+        return 1;
+    }
+
+    finishConstruction();
+
+    return 0;
+}
+
+
+void CompressedGraph::startConstruction(NodeID n, EdgeWeight uniformEdgeWeight, EdgeID edgesHint)
+{
+    m_numberOfNodes = n;
+    m_numberOfEdges = 0;
+    m_uniformEdgeWeight = uniformEdgeWeight;
+    m_uniformNodeWeight = 0;
+
+    m_offsets.clear();
+    m_offsets.reserve(n + 1);
+    m_data.clear();
+    // a degree and about one byte per gap, the weights are guessed with one byte as well
+    m_data.reserve(n + (uniformEdgeWeight != 0 ? 1 : 2) * static_cast<size_t>(edgesHint));
+    m_nodeWeights.clear();
+    m_nodeWeights.reserve(n);
+    m_selfLoops.clear();
+    m_selfLoops.reserve(n);
+    m_weightedNodeDegrees.clear();
+    m_weightedNodeDegrees.reserve(n);
+}
+
+
+void CompressedGraph::addNode(vector<pair<NodeID, EdgeWeight> > &neighbors,
+                              NodeWeight weight, EdgeWeight selfLoop)
+{
+    NodeID node = m_offsets.size();
+    EdgeWeight weightedDegree = 0;
+
+    m_offsets.push_back(m_data.size());
+    m_nodeWeights.push_back(weight);
+    m_selfLoops.push_back(selfLoop);
+
+    // gaps are only small for sorted targets
+    sort(neighbors.begin(), neighbors.end());
+
+    encodeVarint(neighbors.size());
+
+    for (size_t i = 0; i < neighbors.size(); ++i)
+    {
+        if (i == 0)
+        {
+            // the first target is encoded relative to the node (zigzag for the sign)
+            int64_t difference = static_cast<int64_t>(neighbors[i].first) - static_cast<int64_t>(node);
+            encodeVarint((static_cast<uint64_t>(difference) << 1) ^ static_cast<uint64_t>(difference >> 63));
+        }
+        else
+        {
+            encodeVarint(neighbors[i].first - neighbors[i - 1].first - 1);
+        }
+
+        if (m_uniformEdgeWeight == 0)
+        {
+            encodeVarint(static_cast<uint32_t>(neighbors[i].second));
+        }
+
+        weightedDegree += m_uniformEdgeWeight != 0 ? m_uniformEdgeWeight : neighbors[i].second;
+    }
+
+    m_weightedNodeDegrees.push_back(weightedDegree);
+    m_numberOfEdges += neighbors.size();
+}
+
+
+void CompressedGraph::finishConstruction()
+{
+    m_offsets.push_back(m_data.size());
+    // the reserved size is only a guess
+    if (m_data.capacity() > m_data.size() + m_data.size() / 16)
+    {
+        m_data.shrink_to_fit();
+    }
+
+    // node weights and self loops are only stored if necessary
+    bool uniformNodeWeights = true;
+    bool hasSelfLoops = false;
+    for (NodeID n = 0; n < m_numberOfNodes; ++n)
+    {
+        uniformNodeWeights = uniformNodeWeights && m_nodeWeights[n] == m_nodeWeights[0];
+        hasSelfLoops = hasSelfLoops || m_selfLoops[n] != 0;
+    }
+
+    if (m_numberOfNodes == 0 || (uniformNodeWeights && m_nodeWeights[0] != 0))
+    {
+        m_uniformNodeWeight = m_numberOfNodes == 0 ? 1 : m_nodeWeights[0];
+        vector<NodeWeight>().swap(m_nodeWeights);
+    }
+
+    if (!hasSelfLoops)
+    {
+        vector<EdgeWeight>().swap(m_selfLoops);
+    }
+}
+
+
+size_t CompressedGraph::memoryBytes() const
+{
+    return m_data.capacity() * sizeof(uint8_t)
+         + m_offsets.capacity() * sizeof(uint64_t)
+         + m_nodeWeights.capacity() * sizeof(NodeWeight)
+         + m_selfLoops.capacity() * sizeof(EdgeWeight)
+         + m_weightedNodeDegrees.capacity() * sizeof(EdgeWeight);
+}
+
+
+void CompressedGraph::encodeVarint(uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        m_data.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    m_data.push_back(static_cast<uint8_t>(value));
+}
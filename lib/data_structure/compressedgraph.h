@@ -0,0 +1,219 @@
+/******************************************************************************
+ * compressedgraph.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef COMPRESSEDGRAPH_H
+#define COMPRESSEDGRAPH_H
+
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/graph_access.h"
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+/**
+ *  \brief Read-only graph with a compressed adjacency structure, for input graphs
+ *  that do not fit into memory as graph_access or ClusteringGraph.
+ *
+ *  The neighbors of a node are stored sorted as a byte stream:
+ *  the degree, the first target as signed (zigzag) difference to the node
+ *  and then the gaps between consecutive targets, all as varints.
+ *  If not all edges have the same weight, each target is followed by its weight (varint).
+ *  Node weights and self loops are only stored when they are not uniform/present.
+ *
+ *  Compared to graph_access (Edge + coarseningEdge, 16 bytes per directed edge)
+ *  and ClusteringGraph (4 or 8 bytes) a sparse graph with locality needs 1-3 bytes
+ *  per directed edge. The neighbors can only be decoded in order, the kernels
+ *  iterate over them with forall_neighbors() (see ClusteringGraph).
+ *
+ *  read() builds it directly from a file, node by node.
+ */
+class CompressedGraph
+{
+    public:
+        CompressedGraph();
+        virtual ~CompressedGraph();
+
+        /**
+         *  \brief Reads a graph in METIS or binary format (see graph_io::readGraphStreamed()).
+         *
+         *  \return 0 on success.
+         */
+        int read(const std::string &filename);
+
+        /**
+         *  \brief Starts the construction with n nodes, they are added in
+         *  increasing order with addNode().
+         *
+         *  \param uniformEdgeWeight If != 0 all edges have this weight and
+         *  the weights are not stored, otherwise each edge stores its weight.
+         *  \param edgesHint Expected number of directed edges, used to reserve memory.
+         */
+        void startConstruction(NodeID n, EdgeWeight uniformEdgeWeight = 1, EdgeID edgesHint = 0);
+
+        /**
+         *  \brief Appends the next node. neighbors is sorted by target (and
+         *  can therefore be changed). The targets have to be unique.
+         */
+        void addNode(std::vector<std::pair<NodeID, EdgeWeight> > &neighbors,
+                     NodeWeight weight = 1, EdgeWeight selfLoop = 0);
+
+        void finishConstruction();
+
+        NodeID number_of_nodes() const { return m_numberOfNodes; }
+        EdgeID number_of_edges() const { return m_numberOfEdges; }
+
+        EdgeID getNodeDegree(NodeID node) const;
+        NodeWeight getNodeWeight(NodeID node) const;
+        bool containsSelfLoops() const { return !m_selfLoops.empty(); }
+        EdgeWeight getSelfLoop(NodeID node) const { return m_selfLoops.empty() ? 0 : m_selfLoops[node]; }
+
+        /**
+         *  \brief Sum of the weights of the out edges (without the self loop).
+         */
+        EdgeWeight getWeightedNodeDegree(NodeID node) const { return m_weightedNodeDegrees[node]; }
+
+        /**
+         *  \brief TRUE, if all edge weights are 1 and not stored.
+         */
+        bool hasUnitEdgeWeights() const { return m_uniformEdgeWeight == 1; }
+
+        /**
+         *  \brief TRUE, if all node weights are 1.
+         */
+        bool hasUnitNodeWeights() const { return m_uniformNodeWeight == 1; }
+
+        /**
+         *  \brief Hints the CPU to load the encoded neighbors of node into the cache.
+         */
+        void prefetchNeighbors(NodeID node) const
+        {
+            __builtin_prefetch(m_data.data() + m_offsets[node]);
+        }
+
+        /**
+         *  \brief Bytes used by the graph (stream, offsets, node weights, self loops
+         *  and weighted degrees).
+         */
+        size_t memoryBytes() const;
+
+        /**
+         *  \brief Decodes the neighbors of a single node in order, see forall_neighbors().
+         *
+         *  With UnitEdgeWeights (only for graphs with unit edge weights) the weight is 1.
+         */
+        template <bool UnitEdgeWeights>
+        class NeighborCursor
+        {
+            public:
+                NeighborCursor(const CompressedGraph &G, NodeID node)
+                    : m_pos(G.m_data.data() + G.m_offsets[node]),
+                      m_weight(G.m_uniformEdgeWeight)
+                {
+                    m_remaining = decodeVarint(m_pos);
+
+                    if (m_remaining > 0)
+                    {
+                        // zigzag decoding of the difference to the source node
+                        uint64_t value = decodeVarint(m_pos);
+                        m_next = static_cast<NodeID>(static_cast<int64_t>(node) +
+                                                     (static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1)));
+                    }
+                }
+
+                /**
+                 *  \brief Decodes the next neighbor, returns FALSE if there is none.
+                 */
+                bool next(NodeID &target, EdgeWeight &weight)
+                {
+                    if (m_remaining == 0)
+                    {
+                        return false;
+                    }
+
+                    target = m_next;
+                    weight = UnitEdgeWeights ? 1 : (m_weight != 0 ? m_weight : static_cast<EdgeWeight>(decodeVarint(m_pos)));
+
+                    if (--m_remaining > 0)
+                    {
+                        m_next += static_cast<NodeID>(decodeVarint(m_pos)) + 1;
+                    }
+
+                    return true;
+                }
+
+            private:
+                const uint8_t *m_pos;
+                EdgeWeight m_weight;
+                EdgeID m_remaining;
+                NodeID m_next;
+        };
+
+        template <bool UnitEdgeWeights>
+        NeighborCursor<UnitEdgeWeights> neighbors(NodeID node) const
+        {
+            return NeighborCursor<UnitEdgeWeights>(*this, node);
+        }
+
+        static inline uint64_t decodeVarint(const uint8_t *&pos)
+        {
+            // most gaps of a graph with locality fit into a single byte
+            uint64_t value = *pos++;
+            if (value < 0x80)
+            {
+                return value;
+            }
+
+            value &= 0x7F;
+            for (unsigned shift = 7; ; shift += 7)
+            {
+                uint64_t byte = *pos++;
+                value |= (byte & 0x7F) << shift;
+                if (byte < 0x80)
+                {
+                    return value;
+                }
+            }
+        }
+
+    protected:
+        void encodeVarint(uint64_t value);
+
+        NodeID m_numberOfNodes;
+        EdgeID m_numberOfEdges;
+        /// Weight of all edges, 0 if the weights are stored in the stream.
+        EdgeWeight m_uniformEdgeWeight;
+        /// Weight of all nodes, 0 if the weights are stored in m_nodeWeights.
+        NodeWeight m_uniformNodeWeight;
+        /// Start of the neighbors of each node in m_data (size n+1).
+        std::vector<uint64_t> m_offsets;
+        /// The encoded neighbors.
+        std::vector<uint8_t> m_data;
+        std::vector<NodeWeight> m_nodeWeights;
+        /// Empty, if the graph has no self loops.
+        std::vector<EdgeWeight> m_selfLoops;
+        std::vector<EdgeWeight> m_weightedNodeDegrees;
+
+    private:
+};
+
+
+inline EdgeID CompressedGraph::getNodeDegree(NodeID node) const
+{
+    const uint8_t *pos = m_data.data() + m_offsets[node];
+    return static_cast<EdgeID>(decodeVarint(pos));
+}
+
+
+inline NodeWeight CompressedGraph::getNodeWeight(NodeID node) const
+{
+    return m_uniformNodeWeight != 0 ? m_uniformNodeWeight : m_nodeWeights[node];
+}
+
+#endif // COMPRESSEDGRAPH_H
@@ -0,0 +1,268 @@
+/******************************************************************************
+ * component_clustering.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+
+#include "clustering/louvainmethod.h"
+#include "component_clustering.h"
+#include "multilevel_mh_clustering.h"
+#include "parallel_mh_async_clustering.h"
+#include "random_functions.h"
+
+const double component_clustering::EVO_VOLUME_FRACTION = 0.01;
+
+component_clustering::component_clustering() {
+        m_communicator = MPI_COMM_WORLD;
+        MPI_Comm_rank( m_communicator, &m_rank);
+        MPI_Comm_size( m_communicator, &m_size);
+}
+
+component_clustering::component_clustering(MPI_Comm communicator) {
+        m_communicator = communicator;
+        MPI_Comm_rank( m_communicator, &m_rank);
+        MPI_Comm_size( m_communicator, &m_size);
+}
+
+component_clustering::~component_clustering() {
+}
+
+void component_clustering::perform_clustering(const PartitionConfig & config, graph_access & G) {
+        std::vector<NodeID> component;
+        NodeID no_components = compute_components(G, component);
+
+        // nodes of each component, in increasing order (counting sort)
+        std::vector<NodeID> component_start(no_components + 1, 0);
+        std::vector<long long> volume(no_components, 0);
+        long long total_volume = 0;
+        EdgeWeight min_edge_weight = std::numeric_limits<EdgeWeight>::max();
+
+        forall_nodes(G, node) {
+                long long node_volume = G.getWeightedNodeDegree(node);
+                if(G.containsSelfLoops()) node_volume += G.getSelfLoop(node);
+
+                component_start[component[node] + 1]++;
+                volume[component[node]] += node_volume;
+                total_volume            += node_volume;
+
+                forall_out_edges(G, e, node) {
+                        min_edge_weight = std::min(min_edge_weight, G.getEdgeWeight(e));
+                } endfor
+        } endfor
+
+        // the sink node of a component carries the rest of the volume as an EdgeWeight self loop,
+        // the same on all PEs, so they all stop
+        if( total_volume > std::numeric_limits<EdgeWeight>::max() ) {
+                if( m_rank == ROOT ) {
+                        std::cerr <<  "The total edge weight " << total_volume << " is too large for splitting the components. "
+                                  <<  "Currently only 32bit supported!" << std::endl;
+                }
+                MPI_Finalize();
+                exit(1);
+        }
+
+        for( NodeID c = 0; c < no_components; c++) {
+                component_start[c + 1] += component_start[c];
+        }
+
+        std::vector<NodeID> nodes(G.number_of_nodes());
+        std::vector<NodeID> position(component_start.begin(), component_start.end() - 1);
+        forall_nodes(G, node) {
+                nodes[position[component[node]]++] = node;
+        } endfor
+
+        // splitting a connected component C into two parts A, B changes the modularity by
+        // vol(A)*vol(B)/(2m^2) - cut(A,B)/m, which is negative if vol(C)^2 < 8*m*min_edge_weight
+        std::vector<NodeID> larger_components;
+        NodeID largest = 0;
+        for( NodeID c = 0; c < no_components; c++) {
+                double vol = volume[c];
+                if( vol * vol >= 4.0 * total_volume * min_edge_weight ) {
+                        larger_components.push_back(c);
+                }
+                if( volume[c] > volume[largest] ) largest = c;
+        }
+
+        std::sort(larger_components.begin(), larger_components.end(), [&](const NodeID & lhs, const NodeID & rhs) {
+                return volume[lhs] > volume[rhs] || (volume[lhs] == volume[rhs] && lhs < rhs);
+        });
+
+        // the cluster of a node is identified by the smallest node in it,
+        // so the PEs can combine their results with a maximum reduction
+        std::vector<int> cluster_of(G.number_of_nodes(), -1);
+        std::vector<NodeID> local_id(G.number_of_nodes());
+
+        std::vector<NodeID> evo_components;
+        std::vector<NodeID> louvain_components;
+        long long evo_volume = 0;
+        for( NodeID i = 0; i < larger_components.size(); i++) {
+                NodeID c = larger_components[i];
+                if( c == largest || volume[c] >= EVO_VOLUME_FRACTION * total_volume ) {
+                        evo_components.push_back(c);
+                        evo_volume += volume[c];
+                } else {
+                        louvain_components.push_back(c);
+                }
+        }
+
+        // tiny components: one cluster each
+        std::vector<bool> is_larger(no_components, false);
+        for( NodeID i = 0; i < larger_components.size(); i++) is_larger[larger_components[i]] = true;
+
+        for( NodeID c = 0; c < no_components; c++) {
+                if( is_larger[c] ) continue;
+                for( NodeID i = component_start[c]; i < component_start[c + 1]; i++) {
+                        cluster_of[nodes[i]] = nodes[component_start[c]];
+                }
+        }
+
+        // medium components: Louvain, round robin over the PEs
+        random_functions::setSeed(config.seed*m_size+m_rank);
+        for( NodeID i = m_rank; i < louvain_components.size(); i += m_size) {
+                NodeID c = louvain_components[i];
+                std::vector<NodeID> component_nodes(nodes.begin() + component_start[c], nodes.begin() + component_start[c + 1]);
+
+                graph_access subgraph;
+                extract_component(G, component_nodes, local_id, total_volume, subgraph);
+
+                PartitionConfig working_config = config;
+                LouvainMethod lm;
+                lm.performClusteringWithLPP(working_config, &subgraph);
+
+                std::vector<int> smallest_node(subgraph.number_of_nodes(), -1);
+                for( NodeID j = 0; j < component_nodes.size(); j++) {
+                        int & representative = smallest_node[subgraph.getPartitionIndex(j)];
+                        if( representative == -1 ) representative = component_nodes[j];
+                        cluster_of[component_nodes[j]] = representative;
+                }
+        }
+
+        if( m_size > 1 ) {
+                MPI_Allreduce(MPI_IN_PLACE, &cluster_of[0], G.number_of_nodes(), MPI_INT, MPI_MAX, m_communicator);
+        }
+
+        // large components: evolutionary algorithm on all PEs, one after another
+        for( NodeID i = 0; i < evo_components.size(); i++) {
+                NodeID c = evo_components[i];
+                std::vector<NodeID> component_nodes(nodes.begin() + component_start[c], nodes.begin() + component_start[c + 1]);
+
+                graph_access subgraph;
+                extract_component(G, component_nodes, local_id, total_volume, subgraph);
+
+                PartitionConfig working_config = config;
+                working_config.time_limit = config.time_limit * volume[c] / (double) evo_volume;
+
+                if( m_rank == ROOT ) {
+                        std::cout <<  "component with " << component_nodes.size() << " nodes, time limit "
+                                  << working_config.time_limit << std::endl;
+                }
+
+                if( config.mh_coarsening_levels > 0 ) {
+                        multilevel_mh_clustering mh(m_communicator);
+                        mh.perform_partitioning(working_config, subgraph);
+                } else {
+                        parallel_mh_async_clustering mh(m_communicator);
+                        mh.perform_partitioning(working_config, subgraph);
+                }
+
+                std::vector<int> smallest_node(subgraph.number_of_nodes(), -1);
+                for( NodeID j = 0; j < component_nodes.size(); j++) {
+                        int & representative = smallest_node[subgraph.getPartitionIndex(j)];
+                        if( representative == -1 ) representative = component_nodes[j];
+                        cluster_of[component_nodes[j]] = representative;
+                }
+        }
+
+        // consecutive cluster IDs
+        std::vector<PartitionID> new_id(G.number_of_nodes(), UNDEFINED_NODE);
+        PartitionID no_clusters = 0;
+        forall_nodes(G, node) {
+                PartitionID & id = new_id[cluster_of[node]];
+                if( id == UNDEFINED_NODE ) id = no_clusters++;
+                G.setPartitionIndex(node, id);
+        } endfor
+        G.set_partition_count(no_clusters);
+
+        if( m_rank == ROOT ) {
+                std::cout <<  "components " << no_components
+                          <<  " (single cluster " << no_components - larger_components.size()
+                          <<  ", louvain " << louvain_components.size()
+                          <<  ", evolutionary " << evo_components.size() << ")" << std::endl;
+        }
+}
+
+NodeID component_clustering::compute_components(graph_access & G, std::vector<NodeID> & component) {
+        component.assign(G.number_of_nodes(), UNDEFINED_NODE);
+        std::vector<NodeID> queue;
+        queue.reserve(G.number_of_nodes());
+
+        NodeID no_components = 0;
+        forall_nodes(G, start) {
+                if( component[start] != UNDEFINED_NODE ) continue;
+
+                queue.clear();
+                queue.push_back(start);
+                component[start] = no_components;
+
+                for( NodeID head = 0; head < queue.size(); head++) {
+                        NodeID node = queue[head];
+                        forall_out_edges(G, e, node) {
+                                NodeID target = G.getEdgeTarget(e);
+                                if( component[target] == UNDEFINED_NODE ) {
+                                        component[target] = no_components;
+                                        queue.push_back(target);
+                                }
+                        } endfor
+                }
+
+                no_components++;
+        } endfor
+
+        return no_components;
+}
+
+void component_clustering::extract_component(graph_access & G, const std::vector<NodeID> & nodes,
+                                             std::vector<NodeID> & local_id, long long total_volume,
+                                             graph_access & subgraph) {
+        EdgeID no_edges = 0;
+        for( NodeID i = 0; i < nodes.size(); i++) {
+                local_id[nodes[i]] = i;
+                no_edges += G.getNodeDegree(nodes[i]);
+        }
+
+        long long volume = 0;
+        subgraph.start_construction(nodes.size() + 1, no_edges);
+        for( NodeID i = 0; i < nodes.size(); i++) {
+                NodeID node = nodes[i];
+                NodeID shadow_node = subgraph.new_node();
+                subgraph.setNodeWeight(shadow_node, G.getNodeWeight(node));
+                subgraph.setPartitionIndex(shadow_node, 0);
+
+                forall_out_edges(G, e, node) {
+                        EdgeID shadow_edge = subgraph.new_edge(shadow_node, local_id[G.getEdgeTarget(e)]);
+                        subgraph.setEdgeWeight(shadow_edge, G.getEdgeWeight(e));
+                        volume += G.getEdgeWeight(e);
+                } endfor
+        }
+
+        // carries the edge weight of the rest of the graph
+        NodeID sink = subgraph.new_node();
+        subgraph.setNodeWeight(sink, 1);
+        subgraph.setPartitionIndex(sink, 0);
+        subgraph.finish_construction();
+
+        subgraph.resizeSelfLoops(nodes.size() + 1);
+        for( NodeID i = 0; i < nodes.size(); i++) {
+                if( G.containsSelfLoops() ) {
+                        subgraph.setSelfLoop(i, G.getSelfLoop(nodes[i]));
+                        volume += G.getSelfLoop(nodes[i]);
+                }
+        }
+        subgraph.setSelfLoop(sink, (EdgeWeight) (total_volume - volume));
+        subgraph.set_partition_count(1);
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ * component_clustering.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+#ifndef COMPONENT_CLUSTERING_H
+#define COMPONENT_CLUSTERING_H
+
+#ifdef USE_MPI
+#include <mpi.h>
+#else
+#include "tools/pseudo_mpi.h"
+#endif
+#include <vector>
+
+#include "data_structure/graph_access.h"
+#include "partition_config.h"
+
+// Clusters the connected components of a graph independently.
+// An optimal clustering never contains a cluster that spans two components.
+//  - tiny components, for which a single cluster is provably optimal, become one cluster,
+//  - large components (at least EVO_VOLUME_FRACTION of the total volume, at least the
+//    largest one) are clustered one after another by the evolutionary algorithm,
+//    the time limit is split by their volume,
+//  - the remaining components are clustered by the Louvain method, distributed over the PEs.
+// Each component is clustered together with an isolated node whose self loop carries the
+// remaining edge weight of the graph. Thus the modularity of the component graph is computed
+// with the total edge weight of the whole graph and its optimum is exact.
+class component_clustering {
+public:
+        component_clustering();
+        component_clustering(MPI_Comm communicator);
+        virtual ~component_clustering();
+
+        void perform_clustering(const PartitionConfig & config, graph_access & G);
+
+        static const double EVO_VOLUME_FRACTION;
+
+private:
+        // returns the number of components
+        NodeID compute_components(graph_access & G, std::vector<NodeID> & component);
+
+        // subgraph induced by nodes (the local IDs are the positions in nodes), plus
+        // the isolated node nodes.size() with a self loop of total_volume - volume(nodes),
+        // total_volume has to fit into an EdgeWeight
+        void extract_component(graph_access & G, const std::vector<NodeID> & nodes,
+                               std::vector<NodeID> & local_id, long long total_volume,
+                               graph_access & subgraph);
+
+        int      m_rank;
+        int      m_size;
+        MPI_Comm m_communicator;
+};
+
+#endif /* end of include guard: COMPONENT_CLUSTERING_H */
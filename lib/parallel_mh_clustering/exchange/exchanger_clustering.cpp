@@ -104,35 +104,46 @@ void exchanger_clustering::diversify_population_clustering( PartitionConfig & co
         } else {
                 island.get_random_individuum(in);
         }
-        exchange_individum( config, G, from, rank, to, in, out);
+        // individuals are exchanged on the input graph
+        Individuum send = in;
+        std::vector<int> input_map(G.number_of_nodes());
+        island.project_to_input(G, in.partition_map, &input_map[0]);
+        send.partition_map = &input_map[0];
+
+        exchange_individum( config, G, island, from, rank, to, send, out);
+        island.restrict_to_working_graph(G, out);
 
         if( replace ) {
                 island.replace( in, out );
         } else {
-                island.insert( G, out );
+                island.insert( island.working_graph(G), out );
         }
 
 }
 
 void exchanger_clustering::quick_start( PartitionConfig & config, graph_access & G, population_clustering & island ) {
-        int comm_size;
+        int rank, comm_size;
+        MPI_Comm_rank( m_communicator, &rank);
         MPI_Comm_size( m_communicator, &comm_size);
-        
+
+        // one individual has already been created during the initialization
         unsigned no_of_individuals = ceil(config.mh_pool_size / (double)comm_size) - 1;
 
-        std::cout <<  "creating " <<  no_of_individuals << std::endl;
+        std::cout <<  "rank " <<  rank <<  ": quick start creating " <<  no_of_individuals << std::endl;
 
-        for(unsigned i = 0; i < no_of_individuals; i++) {
+        for(unsigned i = 0; i < no_of_individuals && !island.is_full(); i++) {
                 PartitionConfig copy            = config;
                 copy.combine                    = false;
                 copy.graph_allready_partitioned = false;
 
                 Individuum ind;
-                island.createIndividuum(config, G, ind, true);
+                island.createIndividuum(copy, G, ind, true);
                 island.insert(G, ind);
         }
 
-        int reps = config.mh_pool_size - no_of_individuals;
+        // the diversification is a collective operation, hence every PE has to 
+        // perform the same number of exchanges (the pool sizes are equal on all PEs)
+        int reps = config.mh_pool_size - no_of_individuals - 1;
         if(reps < 0) reps = 0;
 
         PartitionConfig div_config   = config;
@@ -144,6 +155,7 @@ void exchanger_clustering::quick_start( PartitionConfig & config, graph_access &
 
 
 void exchanger_clustering::exchange_individum( const PartitionConfig & config,  graph_access & G, 
+                                    population_clustering & island, 
                                     int & from, int & rank, int & to, 
                                     Individuum & in, Individuum & out) {
         //recv. edge cut, partition_map, cut_edges from "from"
@@ -169,7 +181,7 @@ void exchanger_clustering::exchange_individum( const PartitionConfig & config,
         } endfor
 
         G.set_partition_count(G.get_partition_count_compute());
-        out.objective = ModularityMetric::computeModularity(G);
+        out.objective = island.fitness(G);
         std::cout <<  "recv with " << out.objective << std::endl;
 }
 
@@ -276,8 +288,9 @@ void exchanger_clustering::recv_incoming( PartitionConfig & config, graph_access
                 } endfor
 
                 G.set_partition_count(G.get_partition_count_compute());
-                out.objective = ModularityMetric::computeModularity(G);
-                island.insert( G, out );
+                out.objective = island.fitness(G);
+                island.restrict_to_working_graph(G, out);
+                island.insert( island.working_graph(G), out );
 
                 if( out.objective > m_prev_best_objective) {
                         m_prev_best_objective = out.objective;
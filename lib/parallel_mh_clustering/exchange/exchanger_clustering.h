@@ -14,7 +14,7 @@
 #endif
 
 #include "data_structure/graph_access.h"
-#include "parallel_mh_clustering/population_clustering.h"
+#include "../population_clustering.h"
 #include "partition_config.h"
 #include "tools/quality_metrics.h"
 
@@ -31,6 +31,7 @@ public:
 private:
         void exchange_individum(const PartitionConfig & config, 
                                 graph_access & G, 
+                                population_clustering & island, 
                                 int & from, 
                                 int & rank, 
                                 int & to, 
@@ -0,0 +1,141 @@
+/******************************************************************************
+ * multilevel_mh_clustering.cpp
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "clustering/coarsening/coarsening.h"
+#include "clustering/louvainmethod.h"
+#include "coarsening/clustering/size_constraint_label_propagation.h"
+#include "data_structure/graph_hierarchy.h"
+#include "multilevel_mh_clustering.h"
+#include "parallel_mh_async_clustering.h"
+#include "random_functions.h"
+#include "timer.h"
+
+const unsigned multilevel_mh_clustering::LOUVAIN_SPLITS = 2;
+
+multilevel_mh_clustering::multilevel_mh_clustering() {
+        m_communicator = MPI_COMM_WORLD;
+        MPI_Comm_rank( m_communicator, &m_rank);
+}
+
+multilevel_mh_clustering::multilevel_mh_clustering(MPI_Comm communicator) {
+        m_communicator = communicator;
+        MPI_Comm_rank( m_communicator, &m_rank);
+}
+
+multilevel_mh_clustering::~multilevel_mh_clustering() {
+}
+
+void multilevel_mh_clustering::perform_partitioning(const PartitionConfig & config, graph_access & G) {
+        graph_hierarchy hierarchy;
+        std::list<graph_access*> coarse_graphs_to_delete;
+        graph_access* current = &G;
+        unsigned coarsenings  = 0;
+        timer t;
+
+        // the same seed on all PEs, the coarse graphs have to be identical
+        random_functions::setSeed(config.seed);
+
+        // the evolutionary algorithm cannot split a coarse node, so the clusters of the
+        // coarsening are size constrained, the bound keeps at least about
+        // mh_coarsening_minimum_nodes nodes on the coarsest graph
+        NodeID minimum_nodes = std::max<NodeID>(config.mh_coarsening_minimum_nodes, 1);
+        double total_weight  = 0;
+        forall_nodes(G, node) {
+                total_weight += G.getNodeWeight(node);
+        } endfor
+        NodeWeight cluster_upperbound = std::max(1.0, ceil(total_weight / minimum_nodes));
+
+        for( unsigned level = 0; level < config.mh_coarsening_levels; level++) {
+                if( current->number_of_nodes() <= minimum_nodes ) break;
+
+                NodeID no_blocks = 0;
+                std::vector< NodeWeight > cluster_id;
+                size_constraint_label_propagation sclp;
+                sclp.label_propagation(config, *current, cluster_upperbound, cluster_id, no_blocks);
+
+                // label propagation ignores the objective, the coarse nodes are also
+                // split by Louvain clusterings, so they rarely cross a good cluster
+                for( unsigned run = 0; run < LOUVAIN_SPLITS; run++) {
+                        split_by_louvain(config, *current, cluster_id, no_blocks);
+                }
+
+                if( no_blocks == current->number_of_nodes() ) break;
+
+                forall_nodes((*current), node) {
+                        current->setPartitionIndex(node, cluster_id[node]);
+                } endfor
+
+                current = Coarsening::performCoarsening(config, *current, hierarchy, coarse_graphs_to_delete);
+                coarsenings++;
+        }
+
+        if( m_rank == ROOT ) {
+                std::cout <<  "coarsening: " << coarsenings << " levels, nodes " << G.number_of_nodes()
+                          <<  " -> " << current->number_of_nodes() << ", edges " << G.number_of_edges()
+                          <<  " -> " << current->number_of_edges() << ", time " << t.elapsed() << std::endl;
+        }
+
+        // the coarsening is part of the time limit
+        PartitionConfig working_config = config;
+        working_config.time_limit = std::max(0.0, config.time_limit - t.elapsed());
+
+        forall_nodes((*current), node) {
+                current->setPartitionIndex(node, 0);
+        } endfor
+        current->set_partition_count(1);
+
+        parallel_mh_async_clustering mh(m_communicator);
+        mh.perform_partitioning(working_config, *current);
+        current->set_partition_count(current->get_partition_count_compute());
+
+        // uncoarsening with refinement on each level
+        t.restart();
+        random_functions::setSeed(config.seed);
+        hierarchy.push_back(current, 0);
+
+        while( coarsenings > 0 && !hierarchy.isEmpty() ) {
+                current = hierarchy.pop_finer_and_project();
+
+                LouvainMethod lm;
+                lm.performRefinement(config, current);
+        }
+        G.set_partition_count(G.get_partition_count_compute());
+
+        while( !coarse_graphs_to_delete.empty() ) {
+                delete coarse_graphs_to_delete.front();
+                coarse_graphs_to_delete.pop_front();
+        }
+
+        if( m_rank == ROOT ) {
+                std::cout <<  "uncoarsening time " << t.elapsed() << std::endl;
+        }
+}
+
+void multilevel_mh_clustering::split_by_louvain(const PartitionConfig & config, graph_access & G,
+                                                std::vector<NodeWeight> & cluster_id, NodeID & no_blocks) {
+        PartitionConfig louvain_config = config;
+        LouvainMethod lm;
+        lm.performClustering(louvain_config, &G, true);
+
+        // the new clusters are the pairs of a label propagation and a Louvain cluster
+        std::unordered_map< unsigned long long, NodeID > split_id;
+        forall_nodes(G, node) {
+                unsigned long long key = (unsigned long long) cluster_id[node] << 32 | G.getPartitionIndex(node);
+                std::unordered_map< unsigned long long, NodeID >::iterator it = split_id.find(key);
+                if( it == split_id.end() ) {
+                        it = split_id.insert(std::make_pair(key, (NodeID) split_id.size())).first;
+                }
+                cluster_id[node] = it->second;
+        } endfor
+        no_blocks = split_id.size();
+}
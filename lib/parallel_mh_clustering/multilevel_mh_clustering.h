@@ -0,0 +1,51 @@
+/******************************************************************************
+ * multilevel_mh_clustering.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+#ifndef MULTILEVEL_MH_CLUSTERING_H
+#define MULTILEVEL_MH_CLUSTERING_H
+
+#ifdef USE_MPI
+#include <mpi.h>
+#else
+#include "tools/pseudo_mpi.h"
+#endif
+
+#include <vector>
+
+#include "data_structure/graph_access.h"
+#include "partition_config.h"
+
+// Runs the evolutionary algorithm on a coarsened graph:
+//  1. up to config.mh_coarsening_levels levels of size constrained label propagation,
+//     split by Louvain clusterings, and contraction. The coarsening stops at
+//     config.mh_coarsening_minimum_nodes nodes, the cluster weight is at most the
+//     total node weight divided by it,
+//  2. parallel_mh_async_clustering on the coarsest graph,
+//  3. projection of the best clustering through the graph hierarchy,
+//     refined by Louvain node moves on each level.
+// All PEs build the same hierarchy, so the individuals can be exchanged.
+class multilevel_mh_clustering {
+public:
+        multilevel_mh_clustering();
+        multilevel_mh_clustering(MPI_Comm communicator);
+        virtual ~multilevel_mh_clustering();
+
+        void perform_partitioning(const PartitionConfig & config, graph_access & G);
+
+        // number of Louvain clusterings that split the label propagation clusters of a level
+        static const unsigned LOUVAIN_SPLITS;
+
+private:
+        // splits the clusters of cluster_id by a Louvain clustering of G, no_blocks is
+        // the new number of clusters (the partition indices of G are overwritten)
+        void split_by_louvain(const PartitionConfig & config, graph_access & G,
+                              std::vector<NodeWeight> & cluster_id, NodeID & no_blocks);
+
+        int      m_rank;
+        MPI_Comm m_communicator;
+};
+
+#endif /* end of include guard: MULTILEVEL_MH_CLUSTERING_H */
@@ -56,18 +56,33 @@ void parallel_mh_async_clustering::perform_partitioning(const PartitionConfig &
         srand(partition_config.seed*m_size+m_rank);
         random_functions::setSeed(partition_config.seed*m_size+m_rank);
 
+        if( partition_config.mh_deterministic && m_size > 1 && m_rank == ROOT ) {
+                std::cout <<  "deterministic mode: the exchanges between the PEs still depend on the timing" << std::endl;
+        }
+
         PartitionConfig ini_working_config  = partition_config; 
         initialize( ini_working_config, G);
 
         global_timer_restart();
         exchanger_clustering ex(m_communicator);
+        if( partition_config.mh_enable_quickstart && m_size > 1 ) {
+                // every PE only builds its share of the pool, the rest is filled by exchanges
+                ex.quick_start( ini_working_config, G, *m_island );
+        }
+
         do {
                 PartitionConfig working_config  = partition_config; 
 
                 perform_local_partitioning( working_config, G );
 
+                if( partition_config.mh_consensus_interval > 0 && m_island->is_full() 
+                    && (m_rounds + 1) % partition_config.mh_consensus_interval == 0) {
+                        // continue on the graph contracted by the consensus of the pool
+                        m_island->contract_by_consensus( G );
+                }
+
                 //push and recv 
-                if( global_timer_elapsed() <= m_time_limit && m_size > 1) {
+                if( !stop_evolution(partition_config) && m_size > 1) {
                         unsigned messages = ceil(log(m_size));
                         for( unsigned i = 0; i < messages; i++) {
                                 ex.push_best( working_config, G, *m_island );
@@ -76,7 +91,7 @@ void parallel_mh_async_clustering::perform_partitioning(const PartitionConfig &
                 }
 
                 m_rounds++;
-        } while( global_timer_elapsed() <= m_time_limit );
+        } while( !stop_evolution(partition_config) );
 
         collect_best_partitioning(G, partition_config);
 
@@ -117,9 +132,16 @@ void parallel_mh_async_clustering::initialize(PartitionConfig & working_config,
         double fraction     = working_config.mh_initial_population_fraction;
         int POPSIZE_TAG     = 10;
 
-        if( m_rank == ROOT ) {
+        if( working_config.mh_deterministic ) {
+                // the running time of the first clustering would make the pool size differ
+                population_size = working_config.mh_pool_size;
+        } else if( m_rank == ROOT ) {
                 double fraction_to_spend_for_IP = (double)m_time_limit / fraction;
                 population_size                 = ceil(fraction_to_spend_for_IP / time_spend);
+                if( working_config.mh_enable_quickstart ) {
+                        // the PEs create the initial population together
+                        population_size *= m_size;
+                }
 
                 for( int target = 1; target < m_size; target++) {
                         MPI_Request rq;
@@ -139,6 +161,14 @@ void parallel_mh_async_clustering::initialize(PartitionConfig & working_config,
 
 }
 
+bool parallel_mh_async_clustering::stop_evolution(const PartitionConfig & config) {
+        if( config.mh_deterministic ) {
+                return m_rounds >= config.mh_deterministic_rounds;
+        }
+
+        return global_timer_elapsed() > m_time_limit;
+}
+
 double parallel_mh_async_clustering::collect_best_partitioning(graph_access & G, const PartitionConfig & config) {
         //perform partitioning locally
         double max_objective = 0;
@@ -177,12 +207,15 @@ double parallel_mh_async_clustering::perform_local_partitioning(PartitionConfig
         quality_metrics qm;
         unsigned local_repetitions = working_config.local_partitioning_repetitions;
 
+        // the operators work on the consensus contraction of G (if any)
+        graph_access & W = m_island->working_graph(G);
+
         //start a new round
         for( unsigned i = 0; i < local_repetitions; i++) {
                 if( !m_island->is_full()) {
                         Individuum first_ind;
-                        m_island->createIndividuum(working_config, G, first_ind, true);
-                        m_island->insert(G, first_ind);
+                        m_island->createIndividuum(working_config, W, first_ind, true);
+                        m_island->insert(W, first_ind);
                 } else {
                         //perform combine operations
                         Individuum first_rnd;
@@ -192,30 +225,30 @@ double parallel_mh_async_clustering::perform_local_partitioning(PartitionConfig
                         
                         int decision = random_functions::nextInt(0,86);
                         if( 0 <= decision && decision <= 20) {
-                              m_island->combine_basic_flat(working_config, G, first_rnd, second_rnd, output);
+                              m_island->combine_basic_flat(working_config, W, first_rnd, second_rnd, output);
                         }        
                         if( 21 <= decision && decision <= 40) {
-                              m_island->combine_improved_flat(working_config, G, first_rnd, second_rnd, output);
+                              m_island->combine_improved_flat(working_config, W, first_rnd, second_rnd, output);
                         }
                         if( 41 <= decision && decision <= 60) {
-                              m_island->combine_improved_flat_with_sclp(working_config, G, first_rnd, output);
+                              m_island->combine_improved_flat_with_sclp(working_config, W, first_rnd, output);
                         } 
                         if( 61 <= decision && decision <= 80) {
-                              m_island->combine_improved_multilevel(working_config, G, first_rnd, second_rnd, output);
+                              m_island->combine_improved_multilevel(working_config, W, first_rnd, second_rnd, output);
                         }
                         if( 81 <= decision && decision <= 83) {
-                              m_island->combine_improved_flat_with_partitioning(working_config, G, first_rnd, output);
+                              m_island->combine_improved_flat_with_partitioning(working_config, W, first_rnd, output);
                         } 
                         if( 84 <= decision && decision <= 86) {
-                              m_island->mutate(working_config, G, first_rnd, second_rnd, output);
+                              m_island->mutate(working_config, W, first_rnd, second_rnd, output);
                         }
 
                         
-                        m_island->insert(G, output);
+                        m_island->insert(W, output);
                 }
 
                 //try to combine to random inidividuals from pool 
-                if( global_timer_elapsed() > m_time_limit ) {
+                if( !working_config.mh_deterministic && global_timer_elapsed() > m_time_limit ) {
                         break;
                 }
         }
@@ -30,6 +30,9 @@ public:
         void perform_cycle_partitioning(PartitionConfig & graph_partitioner_config, graph_access & G);
 
 private:
+        // true if the time limit is over, in deterministic mode if the rounds are done
+        bool stop_evolution(const PartitionConfig & config);
+
         //misc
         const unsigned MASTER;
         int      m_rank;
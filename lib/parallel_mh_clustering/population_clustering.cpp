@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <math.h>
 #ifdef USE_MPI
 #include <mpi.h>
@@ -26,9 +27,13 @@
 #include "uncoarsening/refinement/cycle_improvements/cycle_refinement.h"
 #include "clustering/louvainmethod.h"
 #include "clustering/coarsening/contractor.h"
+#include "clustering/fmrefinement.h"
 #include "partition/coarsening/clustering/size_constraint_label_propagation.h"
 #include "tools/modularitymetric.h"
-#include "tools/graph_extractor.h"
+#include "data_structure/clusteringgraph.h"
+
+const double population_clustering::CONSENSUS_MIN_SHRINK = 0.05;
+const unsigned population_clustering::PARTITION_CACHE_SIZE = 16;
 
 population_clustering::population_clustering( MPI_Comm communicator, const PartitionConfig & partition_config ) {
         m_population_clustering_size    = partition_config.mh_pool_size;
@@ -38,8 +43,24 @@ population_clustering::population_clustering( MPI_Comm communicator, const Parti
         m_num_ENCs           = 0;
         m_time_stamp         = 0;
         m_communicator       = communicator;
+        m_visit_block_edges  = partition_config.lm_visit_block_edges;
+        m_objective          = partition_config.lm_objective;
+        m_resolution         = partition_config.lm_resolution;
+        m_exact_gains        = partition_config.lm_exact_gains;
+        m_heavy_node_degree  = partition_config.lm_heavy_node_degree;
+        m_heavy_node_sample  = partition_config.lm_heavy_node_sample;
+        m_minimum_shrink_factor = partition_config.lm_minimum_shrink_factor;
+        m_low_shrink_action  = partition_config.lm_low_shrink_action;
+        m_consensus_graph    = NULL;
+        m_random_streams     = 0;
+
+        int rank, size;
+        MPI_Comm_rank( m_communicator, &rank);
+        MPI_Comm_size( m_communicator, &size);
+        m_random_seed        = (unsigned long long) partition_config.seed*size + rank;
+
         global_timer_restart();
-        best_objective = -1;
+        best_objective = -std::numeric_limits<double>::max();
 }
 
 population_clustering::~population_clustering() {
@@ -47,12 +68,17 @@ population_clustering::~population_clustering() {
                 delete[] (m_internal_population_clustering[i].partition_map);
                 delete m_internal_population_clustering[i].cut_edges;
         }         
+        delete m_consensus_graph;
 }
 
 void population_clustering::set_pool_size(int size) {
         m_population_clustering_size = size;
 }
 
+CounterRandom population_clustering::next_random_stream() {
+        return CounterRandom(m_random_seed, m_random_streams++);
+}
+
 void population_clustering::createIndividuum(const PartitionConfig & config, 
                 graph_access & G, 
                 Individuum & ind, bool output) {
@@ -86,7 +112,7 @@ void population_clustering::createIndividuum(const PartitionConfig & config,
         } endfor
 
         G.set_partition_count(G.get_partition_count_compute());
-        ind.objective     = ModularityMetric::computeModularity(G);
+        ind.objective     = fitness(G);
         ind.partition_map = partition_map;
         ind.cut_edges     = new std::vector<EdgeID>();
 
@@ -116,13 +142,7 @@ void population_clustering::insert(graph_access & G, Individuum & ind) {
         if(m_internal_population_clustering.size() < m_population_clustering_size) {
                 m_internal_population_clustering.push_back(ind);
         } else {
-                double worst_objective = 1;
-                for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
-                        if(m_internal_population_clustering[i].objective < worst_objective) {
-                                worst_objective = m_internal_population_clustering[i].objective;
-                        }
-                }         
-                if(ind.objective < worst_objective ) {
+                if(ind.objective < worst_objective() ) {
                         delete[] (ind.partition_map);
                         delete ind.cut_edges;
                         return; // do nothing
@@ -165,6 +185,48 @@ void population_clustering::insert(graph_access & G, Individuum & ind) {
         }
 }
 
+double population_clustering::worst_objective() {
+        double worst_objective = std::numeric_limits<double>::max();
+        for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
+                if(m_internal_population_clustering[i].objective < worst_objective) {
+                        worst_objective = m_internal_population_clustering[i].objective;
+                }
+        }         
+        return worst_objective;
+}
+
+bool population_clustering::reject_offspring(double objective, Individuum & output_ind) {
+        if( !is_full() || objective >= worst_objective() ) return false;
+
+        output_ind.objective     = objective;
+        output_ind.partition_map = NULL;
+        output_ind.cut_edges     = NULL;
+        return true;
+}
+
+void population_clustering::store_offspring(graph_access & G, const clustering_t & clustering, Individuum & output_ind) {
+        int* partition_map = new int[G.number_of_nodes()];
+        forall_nodes(G, node) {
+                partition_map[node] = clustering[node];
+                G.setPartitionIndex(node, clustering[node]);
+        } endfor
+
+        G.set_partition_count(G.get_partition_count_compute());
+        output_ind.partition_map    = partition_map;
+        output_ind.cut_edges        = new std::vector<EdgeID>();
+        compute_cut_edges(G, partition_map, output_ind.cut_edges);
+}
+
+void population_clustering::reject_or_project(graph_access & G, clustering_t & overlap, 
+                clustering_t & contracted_clustering, double quality, Individuum & output_ind) {
+        // the contraction preserves the objective, quality is the fitness of the offspring on G
+        if( reject_offspring(quality, output_ind) ) return;
+
+        update_clustering(overlap, contracted_clustering);
+        store_offspring(G, overlap, output_ind);
+        output_ind.objective = quality;
+}
+
 void population_clustering::replace(Individuum & in, Individuum & out) {
         //first find it:
         for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
@@ -199,27 +261,8 @@ void population_clustering::combine_basic_flat(const PartitionConfig & partition
 
         clustering_t contracted_clustering; double quality;
         std::tie(contracted_clustering, quality) = do_louvain(contracted_graph);
-        update_clustering(output, contracted_clustering);
-
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = output[node];
-                G.setPartitionIndex(node, output[node]);
-        } endfor
-
-        G.set_partition_count(G.get_partition_count_compute());
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
 
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
+        reject_or_project(G, output, contracted_clustering, quality, output_ind);
 }
 
 void population_clustering::combine_improved_multilevel(const PartitionConfig & partition_config, 
@@ -240,6 +283,15 @@ void population_clustering::combine_improved_multilevel(const PartitionConfig &
 
         output = maxmimum_overlap( lhs, rhs);
 
+        // clusters of the parents for each cluster of the overlap
+        unsigned no_overlap = *std::max_element(output.begin(), output.end()) + 1;
+        std::vector< unsigned > lhs_of(no_overlap, 0);
+        std::vector< unsigned > rhs_of(no_overlap, 0);
+        forall_nodes(G, node) {
+                lhs_of[output[node]] = lhs[node];
+                rhs_of[output[node]] = rhs[node];
+        } endfor
+
         graph_access* Q = new graph_access();
         G.copy(*Q);
 
@@ -248,15 +300,18 @@ void population_clustering::combine_improved_multilevel(const PartitionConfig &
 
         std::vector< unsigned > current_clustering;
         std::vector< unsigned > contracted_overlap = output;
+        // overlap cluster of the nodes on each level, the coarse nodes lie in one overlap cluster
+        std::vector< std::vector< unsigned > > level_overlap;
 
         //// constrained louvain
         double q = -1, q_;
 
-        std::mt19937 gen{ std::random_device{}() };
+        CounterRandom gen = next_random_stream();
         while(true) {
                 current_clustering.resize(Q->number_of_nodes());
                 std::iota(current_clustering.begin(), current_clustering.end(), 0);
                 set_second_partition_index(*Q, contracted_overlap);
+                level_overlap.push_back(contracted_overlap);
 
                 q_ = q;
                 q = local_search(*Q, current_clustering, gen, true);
@@ -284,34 +339,41 @@ void population_clustering::combine_improved_multilevel(const PartitionConfig &
         // apply the contracted clustering to the graph and push it onto the hierarchy
         hierarchy.push_back(Q, 0);
 
-        // uncoarsen
+        // uncoarsen, the local search starts where the parents disagree
+        size_t level = level_overlap.size() - 1;
+        std::vector< NodeID > active;
+        FMRefinement fm_refinement;
         while(!hierarchy.isEmpty()) {
                 Q = hierarchy.pop_finer_and_project();
                 extract_clustering(*Q, current_clustering);
 
-                q = local_search(*Q, current_clustering, gen);
-        }
-
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = current_clustering[node];
-                G.setPartitionIndex(node, current_clustering[node]);
-        } endfor
-
-        G.set_partition_count(G.get_partition_count_compute());
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
-
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
+                disagreement_vertices(*Q, level_overlap[--level], lhs_of, rhs_of, active);
+                q = local_search_active(*Q, current_clustering, gen, active);
+
+                if(partition_config.lm_fm_refinement) {
+                        // FM also takes negative gains to leave the local optimum of the local search
+                        ClusteringGraph C;
+                        C.build(*Q);
+                        NodeID moves = 0;
+                        if(m_objective == CPM_OBJECTIVE) {
+                                ObjectiveMetric<ConstantPottsObjective> objective(C, current_clustering, ConstantPottsObjective(m_resolution));
+                                moves = fm_refinement.refine(partition_config, C, current_clustering, objective);
+                        } else if(m_resolution != 1.0) {
+                                ObjectiveMetric<ResolutionModularityObjective> objective(C, current_clustering, ResolutionModularityObjective(m_resolution));
+                                moves = fm_refinement.refine(partition_config, C, current_clustering, objective);
+                        } else {
+                                ObjectiveMetric<ModularityObjective> objective(C, current_clustering, ModularityObjective());
+                                moves = fm_refinement.refine(partition_config, C, current_clustering, objective);
                         }
-                } endfor
-        } endfor
+                        if(moves > 0) {
+                                canonicalize(current_clustering);
+                                apply_clustering(*Q, current_clustering);
+                        }
+                }
+        }
 
+        store_offspring(G, current_clustering, output_ind);
+        output_ind.objective = fitness(G);
 
         for(auto* g: junk) { delete g; }
 }
@@ -346,28 +408,8 @@ void population_clustering::combine_improved_flat(const PartitionConfig & partit
 
         clustering_t new_contracted_clustering; double quality;
         std::tie(new_contracted_clustering, quality) = do_louvain(contracted_graph, contracted_clustering);
-        update_clustering(output, new_contracted_clustering);
-
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = output[node];
-                G.setPartitionIndex(node, output[node]);
-        } endfor
-
-        G.set_partition_count(G.get_partition_count_compute());
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
-
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
 
+        reject_or_project(G, output, new_contracted_clustering, quality, output_ind);
 }
 
 void population_clustering::combine_improved_flat_with_partitioning(const PartitionConfig & partition_config, 
@@ -385,30 +427,50 @@ void population_clustering::combine_improved_flat_with_partitioning(const Partit
         } endfor
 
 
-        PartitionConfig cross_config;
-        configuration{}.standard(cross_config);
-        configuration{}.fastsocial(cross_config);
+        bool reuse = partition_config.mh_partition_cache_reuse > 0 && !m_partition_cache.empty()
+                     && random_functions::nextDouble(0, 1) < partition_config.mh_partition_cache_reuse;
 
-        int kfactor    = random_functions::nextInt(2,64);
-        unsigned larger_imbalance = random_functions::nextInt(3,50);
-        double epsilon = larger_imbalance/100.0;
-        cross_config.k                                    = kfactor;
-        cross_config.kaffpa_perfectly_balanced_refinement = false;
-        cross_config.upper_bound_partition                = (1+epsilon)*ceil(G.number_of_nodes()/(double)kfactor);
-        cross_config.refinement_scheduling_algorithm      = REFINEMENT_SCHEDULING_ACTIVE_BLOCKS;
-        cross_config.combine                              = false;
-        cross_config.graph_allready_partitioned           = false;
+        if( reuse ) {
+                // a partition of an earlier call, with its k and imbalance
+                std::map< std::pair<int, unsigned>, std::vector<unsigned> >::iterator it = m_partition_cache.begin();
+                std::advance(it, random_functions::nextInt(0, m_partition_cache.size() - 1));
+                rhs = it->second;
+        } else {
+                PartitionConfig cross_config;
+                configuration{}.standard(cross_config);
+                configuration{}.fastsocial(cross_config);
+
+                int kfactor    = random_functions::nextInt(2,64);
+                unsigned larger_imbalance = random_functions::nextInt(3,50);
+                double epsilon = larger_imbalance/100.0;
+                cross_config.k                                    = kfactor;
+                cross_config.kaffpa_perfectly_balanced_refinement = false;
+                cross_config.upper_bound_partition                = (1+epsilon)*ceil(G.number_of_nodes()/(double)kfactor);
+                cross_config.refinement_scheduling_algorithm      = REFINEMENT_SCHEDULING_ACTIVE_BLOCKS;
+                cross_config.combine                              = false;
+                cross_config.graph_allready_partitioned           = false;
+
+                //G.set_partition_count(kfactor);
+                balance_configuration bc;
+                bc.configurate_balance( cross_config, G);
 
-        //G.set_partition_count(kfactor);
-        balance_configuration bc;
-        bc.configurate_balance( cross_config, G);
+                graph_partitioner partitioner;
+                partitioner.perform_partitioning(cross_config, G);
 
-        graph_partitioner partitioner;
-        partitioner.perform_partitioning(cross_config, G);
+                forall_nodes(G, node) {
+                        rhs[node] = G.getPartitionIndex(node);
+                } endfor
 
-        forall_nodes(G, node) {
-                rhs[node] = G.getPartitionIndex(node);
-        } endfor
+                std::pair<int, unsigned> key(kfactor, larger_imbalance);
+                if( partition_config.mh_partition_cache_reuse > 0 ) {
+                        if( !m_partition_cache.count(key) && m_partition_cache.size() >= PARTITION_CACHE_SIZE ) {
+                                std::map< std::pair<int, unsigned>, std::vector<unsigned> >::iterator it = m_partition_cache.begin();
+                                std::advance(it, random_functions::nextInt(0, m_partition_cache.size() - 1));
+                                m_partition_cache.erase(it);
+                        }
+                        m_partition_cache[key] = rhs;
+                }
+        }
 
         output = maxmimum_overlap( lhs, rhs);
         graph_access contracted_graph = contract_by_clustering(G, output);
@@ -420,27 +482,8 @@ void population_clustering::combine_improved_flat_with_partitioning(const Partit
 
         clustering_t new_contracted_clustering; double quality;
         std::tie(new_contracted_clustering, quality) = do_louvain(contracted_graph, contracted_clustering);
-        update_clustering(output, new_contracted_clustering);
-
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = output[node];
-                G.setPartitionIndex(node, output[node]);
-        } endfor
-        G.set_partition_count(G.get_partition_count_compute());
-
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
 
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
+        reject_or_project(G, output, new_contracted_clustering, quality, output_ind);
 }
 
 
@@ -481,27 +524,8 @@ void population_clustering::combine_improved_flat_with_sclp(const PartitionConfi
 
         clustering_t new_contracted_clustering; double quality;
         std::tie(new_contracted_clustering, quality) = do_louvain(contracted_graph, contracted_clustering);
-        update_clustering(output, new_contracted_clustering);
 
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = output[node];
-                G.setPartitionIndex(node, output[node]);
-        } endfor
-
-        G.set_partition_count(G.get_partition_count_compute());
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
-
-        forall_nodes(G, node) {
-                forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
-                } endfor
-        } endfor
+        reject_or_project(G, output, new_contracted_clustering, quality, output_ind);
 }
 
 void population_clustering::mutate( const PartitionConfig & partition_config, graph_access & G, Individuum & first_ind, Individuum & second_ind, Individuum & output_ind) {
@@ -520,7 +544,7 @@ void population_clustering::mutate( const PartitionConfig & partition_config, gr
 
 void population_clustering::mutate_random( const PartitionConfig & partition_config, graph_access & G, Individuum & first_ind, Individuum & output_ind) {
         std::vector< unsigned > clustering(G.number_of_nodes(), 0);
-        std::mt19937 gen{ std::random_device{}() };
+        CounterRandom gen = next_random_stream();
         forall_nodes(G, node) {
                 clustering[node] = first_ind.partition_map[node];
         } endfor
@@ -538,63 +562,183 @@ void population_clustering::mutate_random( const PartitionConfig & partition_con
                 while(!selected_clusters.insert(dist(gen)).second);
         }
 
-        forall_nodes(G, node) {
-                G.setPartitionIndex(node, clustering[node]);
-        } endfor
-        G.set_partition_count(G.get_partition_count_compute());
+        // all selected clusters in one pass over the graph
+        std::vector<graph_access*> blocks;
+        std::vector< std::vector<NodeID> > mappings;
+        extract_clusters(G, clustering, selected_clusters, blocks, mappings);
 
         std::uniform_real_distribution<double> dist_eps{ 0.1, 0.5 };
-        for(unsigned cluster: selected_clusters) {
-                graph_access E;
-                std::vector<unsigned> mapping;
-                graph_extractor{ }.extract_block(G, E, cluster, mapping);
+        if( partition_config.mh_mutate_light_split ) {
+                // the epsilons are drawn up front, so the blocks can be split independently,
+                // and each block has its own stream, independent of the threads
+                std::vector<double> eps(blocks.size());
+                for(size_t i = 0; i < blocks.size(); ++i) {
+                        eps[i] = dist_eps(gen);
+                }
 
-                PartitionConfig partition_config;
+                #pragma omp parallel for schedule(dynamic,1)
+                for(int i = 0; i < (int) blocks.size(); ++i) {
+                        CounterRandom block_gen = gen.split(i);
+                        bisect_bfs_lp(*blocks[i], eps[i], block_gen);
+                }
+        } else {
+                // sequential, the partitioner uses the global random state
+                for(size_t i = 0; i < blocks.size(); ++i) {
+                        graph_access & E = *blocks[i];
 
-                configuration cfg;
-                partition_config.k         = 2;
-                cfg.standard(partition_config);
+                        PartitionConfig partition_config;
 
-                double eps                 = dist_eps(gen);
-                partition_config.imbalance = 100*eps;
-                partition_config.epsilon   = 100*eps;
+                        configuration cfg;
+                        partition_config.k         = 2;
+                        cfg.standard(partition_config);
 
-                cfg.fast(partition_config);
+                        double eps                 = dist_eps(gen);
+                        partition_config.imbalance = 100*eps;
+                        partition_config.epsilon   = 100*eps;
 
-                E.set_partition_count(2);
-                balance_configuration bc;
-                bc.configurate_balance(partition_config, E);
+                        cfg.fast(partition_config);
+
+                        E.set_partition_count(2);
+                        balance_configuration bc;
+                        bc.configurate_balance(partition_config, E);
+
+                        graph_partitioner{ }.perform_partitioning(partition_config, E);
+                }
+        }
 
-                graph_partitioner{ }.perform_partitioning(partition_config, E);
-                for(size_t i = 0; i < mapping.size(); ++i) {
-                        if(E.getPartitionIndex(i) == 1) { clustering[mapping[i]] = c; }
+        std::vector<NodeID> mutated;
+        for(size_t i = 0; i < blocks.size(); ++i) {
+                const std::vector<NodeID> & mapping = mappings[i];
+                for(size_t j = 0; j < mapping.size(); ++j) {
+                        if(blocks[i]->getPartitionIndex(j) == 1) { clustering[mapping[j]] = c; }
                 }
+                mutated.insert(mutated.end(), mapping.begin(), mapping.end());
                 ++c;
+
+                delete blocks[i];
         }
 
-        local_search(G, clustering, gen);
+        local_search_active(G, clustering, gen, mutated);
 
-        int* partition_map = new int[G.number_of_nodes()];
-        forall_nodes(G, node) {
-                partition_map[node] = clustering[node];
-                G.setPartitionIndex(node, clustering[node]);
-        } endfor
+        store_offspring(G, clustering, output_ind);
+        output_ind.objective = fitness(G);
+}
 
-        G.set_partition_count(G.get_partition_count_compute());
-        output_ind.objective = ModularityMetric::computeModularity(G);
-        output_ind.partition_map    = partition_map;
-        output_ind.cut_edges        = new std::vector<EdgeID>();
+void population_clustering::extract_clusters(graph_access & G, const clustering_t & clustering,
+                                             const std::set<unsigned> & clusters,
+                                             std::vector<graph_access*> & blocks,
+                                             std::vector< std::vector<NodeID> > & mappings) {
+        unsigned c = *std::max_element(clustering.begin(), clustering.end()) + 1;
+        std::vector<int> block_of(c, -1);
+        unsigned no_blocks = 0;
+        for(unsigned cluster: clusters) { block_of[cluster] = no_blocks++; }
 
+        // nodes and internal edges of each block
+        mappings.assign(no_blocks, std::vector<NodeID>());
+        std::vector<EdgeID> no_edges(no_blocks, 0);
+        std::vector<NodeID> local_id(G.number_of_nodes());
         forall_nodes(G, node) {
+                int block = block_of[clustering[node]];
+                if( block < 0 ) continue;
+
+                local_id[node] = mappings[block].size();
+                mappings[block].push_back(node);
                 forall_out_edges(G, e, node) {
-                        NodeID target = G.getEdgeTarget(e);
-                        if(partition_map[node] != partition_map[target]) {
-                                output_ind.cut_edges->push_back(e);
-                        }
+                        if( clustering[G.getEdgeTarget(e)] == clustering[node] ) no_edges[block]++;
                 } endfor
         } endfor
 
+        blocks.resize(no_blocks);
+        for( unsigned block = 0; block < no_blocks; block++) {
+                graph_access* E = new graph_access();
+                E->start_construction(mappings[block].size(), no_edges[block]);
+
+                for(NodeID node: mappings[block]) {
+                        NodeID new_node = E->new_node();
+                        E->setNodeWeight(new_node, G.getNodeWeight(node));
+                        E->setPartitionIndex(new_node, 0);
+
+                        forall_out_edges(G, e, node) {
+                                NodeID target = G.getEdgeTarget(e);
+                                if( clustering[target] == clustering[node] ) {
+                                        EdgeID new_edge = E->new_edge(new_node, local_id[target]);
+                                        E->setEdgeWeight(new_edge, G.getEdgeWeight(e));
+                                }
+                        } endfor
+                }
+
+                E->finish_construction();
+                blocks[block] = E;
+        }
+}
+
+void population_clustering::bisect_bfs_lp(graph_access & E, double eps, CounterRandom & gen) {
+        const unsigned LP_ITERATIONS = 3;
+
+        NodeWeight total_weight = 0;
+        forall_nodes(E, node) {
+                E.setPartitionIndex(node, 0);
+                total_weight += E.getNodeWeight(node);
+        } endfor
+        E.set_partition_count(2);
+
+        NodeID n = E.number_of_nodes();
+        if( n < 2 ) return;
+
+        // block 1 grows by BFS from a random node until it has half of the weight
+        NodeWeight block_weight[2] = { total_weight, 0 };
+        std::vector<bool> visited(n, false);
+        std::queue<NodeID> queue;
+        NodeID start = std::uniform_int_distribution<NodeID>(0, n - 1)(gen);
+        queue.push(start);
+        visited[start] = true;
+
+        while( !queue.empty() && 2 * block_weight[1] < total_weight ) {
+                NodeID node = queue.front();
+                queue.pop();
+
+                E.setPartitionIndex(node, 1);
+                block_weight[1] += E.getNodeWeight(node);
+                block_weight[0] -= E.getNodeWeight(node);
+
+                forall_out_edges(E, e, node) {
+                        NodeID target = E.getEdgeTarget(e);
+                        if( !visited[target] ) {
+                                visited[target] = true;
+                                queue.push(target);
+                        }
+                } endfor
+        }
+
+        // label propagation with two labels smooths the BFS boundary
+        NodeWeight max_block_weight = (1 + eps) * ceil(total_weight / 2.0);
+        std::vector<NodeID> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        for( unsigned iteration = 0; iteration < LP_ITERATIONS; iteration++) {
+                std::shuffle(order.begin(), order.end(), gen);
+
+                NodeID moves = 0;
+                for(NodeID node: order) {
+                        EdgeWeight connection[2] = { 0, 0 };
+                        forall_out_edges(E, e, node) {
+                                connection[E.getPartitionIndex(E.getEdgeTarget(e))] += E.getEdgeWeight(e);
+                        } endfor
+
+                        PartitionID from = E.getPartitionIndex(node);
+                        PartitionID to   = 1 - from;
+                        NodeWeight weight = E.getNodeWeight(node);
+                        if( connection[to] > connection[from] 
+                            && block_weight[to] + weight <= max_block_weight 
+                            && block_weight[from] > weight ) {
+                                E.setPartitionIndex(node, to);
+                                block_weight[from] -= weight;
+                                block_weight[to]   += weight;
+                                moves++;
+                        }
+                }
 
+                if( moves == 0 ) break;
+        }
 }
 
 void population_clustering::extinction( ) {
@@ -644,7 +788,7 @@ void population_clustering::get_random_individuum(Individuum & ind) {
 }
 
 void population_clustering::get_best_individuum(Individuum & ind) {
-        double max_objective = -1;
+        double max_objective = -std::numeric_limits<double>::max();
         unsigned idx         = 0;
 
         for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
@@ -661,28 +805,157 @@ bool population_clustering::is_full() {
         return m_internal_population_clustering.size() == m_population_clustering_size;
 }
 
+double population_clustering::fitness(graph_access & G) {
+        // plain modularity keeps the fitness of graph_access
+        if( m_objective != CPM_OBJECTIVE && m_resolution == 1.0 ) {
+                return ModularityMetric::computeModularity(G);
+        }
+
+        ClusteringGraph C;
+        C.build(G);
+        clustering_t clustering;
+        extract_clustering(G, clustering);
+
+        if( m_objective == CPM_OBJECTIVE ) {
+                return ObjectiveMetric<ConstantPottsObjective>(C, clustering, ConstantPottsObjective(m_resolution)).quality();
+        }
+        return ObjectiveMetric<ResolutionModularityObjective>(C, clustering, ResolutionModularityObjective(m_resolution)).quality();
+}
+
 void population_clustering::apply_fittest( graph_access & G, double & objective ) {
-        double max_objective = -1;
+        double max_objective = -std::numeric_limits<double>::max();
         unsigned idx         = 0;
 
-        quality_metrics qm;
         for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
-                forall_nodes(G, node) {
-                        G.setPartitionIndex(node, m_internal_population_clustering[i].partition_map[node]);
-                } endfor
                 if(m_internal_population_clustering[i].objective > max_objective) {
                         max_objective = m_internal_population_clustering[i].objective;
                         idx           = i;
                 }
         }
 
+        // G is the input graph, the individuals may be expressed on the consensus graph
+        const int* partition_map = m_internal_population_clustering[idx].partition_map;
         forall_nodes(G, node) {
-                G.setPartitionIndex(node, m_internal_population_clustering[idx].partition_map[node]);
+                G.setPartitionIndex(node, m_consensus_graph ? partition_map[m_consensus_map[node]] : partition_map[node]);
         } endfor
 
         objective = max_objective;
 }
 
+bool population_clustering::contract_by_consensus(graph_access & G) {
+        if( m_internal_population_clustering.size() < 2 ) return false;
+
+        graph_access & W = working_graph(G);
+        NodeID n = W.number_of_nodes();
+        EdgeID m = W.number_of_edges();
+
+        // k-way overlap: two nodes are in the same consensus cluster iff
+        // they are clustered together in every individual
+        clustering_t consensus(n), other(n);
+        forall_nodes(W, node) {
+                consensus[node] = m_internal_population_clustering[0].partition_map[node];
+        } endfor
+
+        for( unsigned i = 1; i < m_internal_population_clustering.size(); i++) {
+                forall_nodes(W, node) {
+                        other[node] = m_internal_population_clustering[i].partition_map[node];
+                } endfor
+                consensus = maxmimum_overlap(consensus, other);
+        }
+
+        NodeID no_consensus = *std::max_element(consensus.begin(), consensus.end()) + 1;
+        if( no_consensus > (1 - CONSENSUS_MIN_SHRINK) * n ) return false;
+
+        ClusteringGraph finer, coarser;
+        finer.build(W);
+        Contractor::contractClustering(finer, consensus, coarser);
+
+        graph_access* contracted = new graph_access();
+        coarser.copyTo(*contracted);
+
+        // re-express the individuals, each consensus cluster lies in one of their clusters
+        std::vector<NodeID> representative(no_consensus);
+        forall_nodes(W, node) {
+                representative[consensus[node]] = node;
+        } endfor
+
+        clustering_t coarse_clustering(no_consensus);
+        for( unsigned i = 0; i < m_internal_population_clustering.size(); i++) {
+                Individuum & ind = m_internal_population_clustering[i];
+                for( NodeID c = 0; c < no_consensus; c++) {
+                        coarse_clustering[c] = ind.partition_map[representative[c]];
+                }
+                canonicalize(coarse_clustering);
+
+                delete[] ind.partition_map;
+                ind.partition_map = new int[no_consensus];
+                std::copy(coarse_clustering.begin(), coarse_clustering.end(), ind.partition_map);
+
+                ind.cut_edges->clear();
+                compute_cut_edges(*contracted, ind.partition_map, ind.cut_edges);
+        }
+
+        if( m_consensus_graph ) {
+                forall_nodes(G, node) {
+                        m_consensus_map[node] = consensus[m_consensus_map[node]];
+                } endfor
+                delete m_consensus_graph;
+        } else {
+                m_consensus_map.assign(consensus.begin(), consensus.end());
+        }
+        m_consensus_graph = contracted;
+
+        // the cached partitions belong to the old working graph
+        m_partition_cache.clear();
+
+        int rank;
+        MPI_Comm_rank( m_communicator, &rank);
+        std::cout <<  "rank " <<  rank <<  " consensus contraction: nodes " <<  n <<  " -> " <<  no_consensus
+                  <<  ", edges " <<  m <<  " -> " <<  contracted->number_of_edges() << std::endl;
+
+        return true;
+}
+
+void population_clustering::project_to_input(graph_access & G, const int* working_map, int* input_map) {
+        forall_nodes(G, node) {
+                input_map[node] = m_consensus_graph ? working_map[m_consensus_map[node]] : working_map[node];
+        } endfor
+}
+
+void population_clustering::restrict_to_working_graph(graph_access & G, Individuum & ind) {
+        if( !m_consensus_graph ) return;
+
+        graph_access & W = *m_consensus_graph;
+        clustering_t coarse_clustering(W.number_of_nodes());
+        forall_nodes(G, node) {
+                coarse_clustering[m_consensus_map[node]] = ind.partition_map[node];
+        } endfor
+        canonicalize(coarse_clustering);
+
+        delete[] ind.partition_map;
+        ind.partition_map = new int[W.number_of_nodes()];
+        forall_nodes(W, node) {
+                ind.partition_map[node] = coarse_clustering[node];
+                W.setPartitionIndex(node, coarse_clustering[node]);
+        } endfor
+
+        W.set_partition_count(W.get_partition_count_compute());
+        ind.objective = fitness(W);
+        ind.cut_edges->clear();
+        compute_cut_edges(W, ind.partition_map, ind.cut_edges);
+}
+
+void population_clustering::compute_cut_edges(graph_access & G, const int* partition_map, std::vector<EdgeID>* cut_edges) {
+        forall_nodes(G, node) {
+                forall_out_edges(G, e, node) {
+                        NodeID target = G.getEdgeTarget(e);
+                        if(partition_map[node] != partition_map[target]) {
+                                cut_edges->push_back(e);
+                        }
+                } endfor
+        } endfor
+}
+
 void population_clustering::print() {
         int rank;
         MPI_Comm_rank( m_communicator, &rank);
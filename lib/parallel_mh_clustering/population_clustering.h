@@ -16,6 +16,10 @@
 #include <unordered_map>
 #include <functional>
 #include <algorithm>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
 
 #include "data_structure/graph_access.h"
 #include "clustering/coarsening/coarsening.h"
@@ -23,8 +27,12 @@
 #include "tools/global_timer.h"
 #include "clustering/louvainmethod.h"
 #include "configuration.h"
+#include "data_structure/clusteringgraph.h"
+#include "tools/counterrandom.h"
 #include "tools/modularitymetric.h"
+#include "tools/objectivemetric.h"
 #include "tools/random_functions.h"
+#include "tools/visitorder.h"
 
 struct Individuum {
         int* partition_map;
@@ -114,12 +122,38 @@ class population_clustering {
 
                 void apply_fittest( graph_access & G, double & objective);
 
+                /* quality of the clustering in the partition indices of G under the objective of
+                 * the user (modularity, with resolution, or constant Potts model). this is the
+                 * fitness of the individuals. */
+                double fitness(graph_access & G);
+
                 unsigned size() { return m_internal_population_clustering.size(); }
 
                 void print();
 
                 void write_log(std::string & filename);
 
+                /* contracts the working graph by the consensus (k-way overlap) of all individuals
+                 * and re-expresses the individuals on the contracted graph, their modularity does
+                 * not change. does nothing and returns false if the working graph would shrink by
+                 * less than CONSENSUS_MIN_SHRINK. G is the input graph. */
+                bool contract_by_consensus(graph_access & G);
+
+                /* the graph the individuals are expressed on: G or its consensus contraction */
+                graph_access & working_graph(graph_access & G) { return m_consensus_graph ? *m_consensus_graph : G; }
+
+                /* maps a clustering of the working graph to the input graph G */
+                void project_to_input(graph_access & G, const int* working_map, int* input_map);
+
+                /* re-expresses an individual of the input graph G (e.g. received from another PE)
+                 * on the working graph. each contracted node takes the cluster of one of its nodes. */
+                void restrict_to_working_graph(graph_access & G, Individuum & ind);
+
+                static const double CONSENSUS_MIN_SHRINK;
+
+                // maximum number of partitions kept for combine_improved_flat_with_partitioning
+                static const unsigned PARTITION_CACHE_SIZE;
+
                 /* updates old clustering with a new clustering of a possibly contracted graph.
                  * new_coarse_clustering must be of size max(clustering) + 1, i.e. must have an
                  * entry for every cluster in the old clustering. */
@@ -230,13 +264,21 @@ class population_clustering {
                         partition_config.upper_bound_partition = partition_config.cluster_upperbound; 
                         partition_config.cluster_coarsening_factor = 1;
 
+                        // the Louvain options of the user, the fitness of the individuals uses the same objective
+                        partition_config.lm_objective  = m_objective;
+                        partition_config.lm_resolution = m_resolution;
+                        partition_config.lm_exact_gains = m_exact_gains;
+                        partition_config.lm_heavy_node_degree = m_heavy_node_degree;
+                        partition_config.lm_heavy_node_sample = m_heavy_node_sample;
+                        partition_config.lm_minimum_shrink_factor = m_minimum_shrink_factor;
+                        partition_config.lm_low_shrink_action = m_low_shrink_action;
 
                         LouvainMethod{ }.performClustering(partition_config, &G, c.empty());
 
                         clustering_t clustering(G.number_of_nodes(), -1);
                         extract_clustering(G, clustering);
 
-                        return {clustering, ModularityMetric::computeModularity(G)};
+                        return {clustering, fitness(G)};
                 }
 
 
@@ -266,58 +308,165 @@ class population_clustering {
                         } endfor
                 }
 
+                /* local moves of all vertices until the quality improves by at most eps. the
+                 * objective is the one of the user (m_objective, m_resolution), as the fitness.
+                 * afterwards the partition indices of G hold the clustering. */
                 template <class RNG>
                         double local_search(graph_access& G, clustering_t& clustering, RNG&& gen, bool combine = false, double eps = 0.0001) {
                                 assert(G.number_of_nodes() == clustering.size() && "no!");
 
-                                apply_clustering(G, clustering);
-                                ModularityMetric mod{ G };
+                                ClusteringGraph C;
+                                C.build(G);
+                                canonicalize(clustering);
+
+                                if(m_objective == CPM_OBJECTIVE) {
+                                        ObjectiveMetric<ConstantPottsObjective> objective(C, clustering, ConstantPottsObjective(m_resolution));
+                                        return local_search(G, C, clustering, gen, objective, combine, eps);
+                                } else if(m_resolution != 1.0) {
+                                        ObjectiveMetric<ResolutionModularityObjective> objective(C, clustering, ResolutionModularityObjective(m_resolution));
+                                        return local_search(G, C, clustering, gen, objective, combine, eps);
+                                }
 
+                                ObjectiveMetric<ModularityObjective> objective(C, clustering, ModularityObjective());
+                                return local_search(G, C, clustering, gen, objective, combine, eps);
+                        }
+
+                template <class RNG, typename Objective>
+                        double local_search(graph_access& G, const ClusteringGraph& C, clustering_t& clustering, RNG&& gen,
+                                            ObjectiveMetric<Objective>& objective, bool combine, double eps) {
                                 std::vector<size_t> order(G.number_of_nodes());
-                                std::iota(order.begin(), order.end(), 0);
-                                std::shuffle(order.begin(), order.end(), gen);
+                                if(m_visit_block_edges > 0) {
+                                        VisitOrder::blockPermutation(G, m_visit_block_edges, order, [&](NodeID size) {
+                                                return std::uniform_int_distribution<NodeID>(0, size - 1)(gen);
+                                        });
+                                } else {
+                                        std::iota(order.begin(), order.end(), 0);
+                                        std::shuffle(order.begin(), order.end(), gen);
+                                }
 
-                                double q = mod.quality(), q_;
+                                double q = objective.quality(), q_;
                                 do {
                                         for(size_t i = 0; i < G.number_of_nodes(); ++i) {
-                                                size_t vertex        = order[i];
-                                                unsigned cur_cluster = G.getPartitionIndex(vertex);
+                                                move_to_best_cluster(G, C, clustering, objective, order[i], combine);
+                                        }
 
-                                                std::unordered_map<size_t, size_t> hood_edges{ {cur_cluster, 0} };
-                                                forall_out_edges(G, e, vertex) {
-                                                        NodeID neighbor = G.getEdgeTarget(e);
-                                                        size_t neighbor_cluster = G.getPartitionIndex(neighbor);
+                                        q_ = q; q = objective.quality();
+                                } while(q - q_ > eps);
 
-                                                        if(combine && G.getSecondPartitionIndex(vertex) != G.getSecondPartitionIndex(neighbor)) { continue; }
+                                canonicalize(clustering);
+                                apply_clustering(G, clustering);
 
-                                                        if(hood_edges.count(neighbor_cluster)) {
-                                                                hood_edges[neighbor_cluster] += G.getEdgeWeight(e);
-                                                        } else {
-                                                                hood_edges[neighbor_cluster] = G.getEdgeWeight(e);
-                                                        }
-                                                } endfor
+                                return q;
+                        }
 
-                                                double best_increase = 0;
-                                                auto best_candidate = hood_edges.find(cur_cluster);
+                /* local search that only visits the given active vertices and, after a vertex
+                 * moved, its neighbors. the work is proportional to the changed region instead
+                 * of the graph size (apart from setting up the objective). */
+                template <class RNG>
+                        double local_search_active(graph_access& G, clustering_t& clustering, RNG&& gen, std::vector<NodeID>& active, bool combine = false) {
+                                assert(G.number_of_nodes() == clustering.size() && "no!");
 
-                                                mod.removeNode(vertex, cur_cluster, hood_edges[cur_cluster]);
-                                                for(auto it = hood_edges.begin(); it != hood_edges.end(); ++it) {
-                                                        double new_increase = mod.gain(vertex, it->first, it->second);
-                                                        if(new_increase > best_increase) { best_candidate = it; best_increase = new_increase; }
-                                                }
+                                ClusteringGraph C;
+                                C.build(G);
+                                canonicalize(clustering);
 
-                                                mod.insertNode(vertex, best_candidate->first, best_candidate->second);
-                                        }
+                                if(m_objective == CPM_OBJECTIVE) {
+                                        ObjectiveMetric<ConstantPottsObjective> objective(C, clustering, ConstantPottsObjective(m_resolution));
+                                        return local_search_active(G, C, clustering, gen, objective, active, combine);
+                                } else if(m_resolution != 1.0) {
+                                        ObjectiveMetric<ResolutionModularityObjective> objective(C, clustering, ResolutionModularityObjective(m_resolution));
+                                        return local_search_active(G, C, clustering, gen, objective, active, combine);
+                                }
 
-                                        q_ = q; q = mod.quality();
-                                } while(q - q_ > eps);
+                                ObjectiveMetric<ModularityObjective> objective(C, clustering, ModularityObjective());
+                                return local_search_active(G, C, clustering, gen, objective, active, combine);
+                        }
+
+                template <class RNG, typename Objective>
+                        double local_search_active(graph_access& G, const ClusteringGraph& C, clustering_t& clustering, RNG&& gen,
+                                                   ObjectiveMetric<Objective>& objective, std::vector<NodeID>& active, bool combine) {
+                                std::shuffle(active.begin(), active.end(), gen);
+                                std::vector<bool> queued(G.number_of_nodes(), false);
+                                std::queue<NodeID> queue;
+                                for(NodeID vertex: active) {
+                                        if(!queued[vertex]) { queued[vertex] = true; queue.push(vertex); }
+                                }
+
+                                while(!queue.empty()) {
+                                        NodeID vertex = queue.front();
+                                        queue.pop();
+                                        queued[vertex] = false;
+
+                                        if(move_to_best_cluster(G, C, clustering, objective, vertex, combine) > 0) {
+                                                forall_out_edges(C, e, vertex) {
+                                                        NodeID neighbor = C.getEdgeTarget(e);
+                                                        if(!queued[neighbor]) { queued[neighbor] = true; queue.push(neighbor); }
+                                                } endfor
+                                        }
+                                }
 
-                                extract_clustering(G, clustering);
                                 canonicalize(clustering);
+                                apply_clustering(G, clustering);
 
-                                return q;
+                                return objective.quality();
                         }
 
+                /* moves vertex to the neighboring cluster with the largest gain and returns the
+                 * improvement over staying in its cluster (0 if it stays). C is the compact copy of
+                 * G, objective keeps track of clustering. with combine, only neighbors with the same
+                 * second partition index (of G) are considered. */
+                template <typename Objective>
+                        double move_to_best_cluster(graph_access& G, const ClusteringGraph& C, clustering_t& clustering,
+                                                    ObjectiveMetric<Objective>& objective, NodeID vertex, bool combine) {
+                                PartitionID cur_cluster = clustering[vertex];
+
+                                std::unordered_map<PartitionID, EdgeWeight> hood_edges{ {cur_cluster, 0} };
+                                forall_out_edges(C, e, vertex) {
+                                        NodeID neighbor = C.getEdgeTarget(e);
+
+                                        if(combine && G.getSecondPartitionIndex(vertex) != G.getSecondPartitionIndex(neighbor)) { continue; }
+
+                                        hood_edges[clustering[neighbor]] += C.getEdgeWeight(e);
+                                } endfor
+
+                                // the kernels of the Louvain method choose the unit node weight variant at compile
+                                // time, the local search visits too few vertices for this to matter
+                                EdgeWeight volume    = objective.template nodeVolume<false>(vertex);
+                                EdgeWeight self_loop = C.getSelfLoop(vertex);
+
+                                double best_increase = 0, stay_increase = 0;
+                                auto best_candidate = hood_edges.find(cur_cluster);
+
+                                objective.removeNode(vertex, volume, cur_cluster, hood_edges[cur_cluster], self_loop);
+                                for(auto it = hood_edges.begin(); it != hood_edges.end(); ++it) {
+                                        double new_increase = objective.gain(volume, it->first, it->second);
+                                        if(it->first == cur_cluster) { stay_increase = new_increase; }
+                                        if(new_increase > best_increase) { best_candidate = it; best_increase = new_increase; }
+                                }
+
+                                objective.insertNode(vertex, volume, best_candidate->first, best_candidate->second, self_loop);
+
+                                return best_candidate->first != cur_cluster ? best_increase - stay_increase : 0;
+                        }
+
+                /* vertices incident to an edge that is cut in exactly one of two parents. overlap
+                 * maps the vertices of G to the clusters of the overlap of the parents, lhs_of and
+                 * rhs_of map these to the clusters of the parents. */
+                void disagreement_vertices(graph_access& G, clustering_t const& overlap, clustering_t const& lhs_of,
+                                           clustering_t const& rhs_of, std::vector<NodeID>& active) {
+                        active.clear();
+                        forall_nodes(G, vertex) {
+                                unsigned a = overlap[vertex];
+                                forall_out_edges(G, e, vertex) {
+                                        unsigned b = overlap[G.getEdgeTarget(e)];
+                                        if((lhs_of[a] == lhs_of[b]) != (rhs_of[a] == rhs_of[b])) {
+                                                active.push_back(vertex);
+                                                break;
+                                        }
+                                } endfor
+                        } endfor
+                }
+
                 clustering_t contract_better_clustering_by_contracted_overlap(clustering_t const& overlap, clustering_t const& contracted_overlap, clustering_t const& better) {
                         std::unordered_map<NodeID, NodeID> mapping;
                         for(size_t i = 0; i < better.size(); ++i) {
@@ -331,6 +480,40 @@ class population_clustering {
                 }
 
         private:
+                // smallest objective in the pool
+                double worst_objective();
+
+                /* true if insert() would discard an offspring with this objective. then output_ind
+                 * only carries the objective (no partition_map and cut_edges) and the operator can
+                 * skip the projection to the graph. */
+                bool reject_offspring(double objective, Individuum & output_ind);
+
+                /* stores the clustering of G in output_ind (partition_map and cut_edges) and sets the
+                 * partition indices of G, the objective is left to the caller. */
+                void store_offspring(graph_access & G, const clustering_t & clustering, Individuum & output_ind);
+
+                /* the common end of the flat combine operators: rejects the offspring or projects the
+                 * clustering of the contracted graph through the overlap to G and stores it. */
+                void reject_or_project(graph_access & G, clustering_t & overlap, 
+                                       clustering_t & contracted_clustering, double quality, Individuum & output_ind);
+
+                /* extracts the subgraphs induced by the given clusters in one pass over G, with
+                 * exactly sized edge arrays. mappings[i] holds the nodes of G in blocks[i]. the
+                 * blocks have to be deleted by the caller. */
+                void extract_clusters(graph_access & G, const clustering_t & clustering,
+                                      const std::set<unsigned> & clusters,
+                                      std::vector<graph_access*> & blocks,
+                                      std::vector< std::vector<NodeID> > & mappings);
+
+                /* cheap bisection: BFS from a random node up to half of the weight, smoothed by
+                 * a few rounds of two-label propagation with blocks of at most (1+eps) * half. */
+                static void bisect_bfs_lp(graph_access & E, double eps, CounterRandom & gen);
+
+                /* random numbers of the next operator call. the streams are numbered per PE, so
+                 * the random numbers only depend on the seed, the PE and the order of the calls. */
+                CounterRandom next_random_stream();
+
+                void compute_cut_edges(graph_access & G, const int* partition_map, std::vector<EdgeID>* cut_edges);
 
                 unsigned                m_no_partition_calls;
                 unsigned 		m_population_clustering_size;
@@ -342,10 +525,29 @@ class population_clustering {
                 int m_num_NCs_computed;
                 int m_num_ENCs;
                 int m_time_stamp;
+                unsigned m_visit_block_edges;
+                ClusteringObjectiveType m_objective;
+                double m_resolution;
+                bool m_exact_gains;
+                NodeID m_heavy_node_degree;
+                NodeID m_heavy_node_sample;
+                double m_minimum_shrink_factor;
+                LowShrinkActionType m_low_shrink_action;
                 double best_objective;
 
+                // consensus contraction of the input graph and the node of each input node in it
+                graph_access*           m_consensus_graph;
+                std::vector<NodeID>     m_consensus_map;
+
+                // KaHIP partitions of the working graph, keyed by k and imbalance (in percent)
+                std::map< std::pair<int, unsigned>, std::vector<unsigned> > m_partition_cache;
+
                 MPI_Comm m_communicator;
 
+                // seed of the PE and number of random streams used so far
+                unsigned long long m_random_seed;
+                unsigned long long m_random_streams;
+
                 std::stringstream m_filebuffer_string;
 };
 
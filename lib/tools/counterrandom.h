@@ -0,0 +1,66 @@
+/******************************************************************************
+ * counterrandom.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef COUNTERRANDOM_H
+#define COUNTERRANDOM_H
+
+#include <cstdint>
+#include <limits>
+
+
+/**
+ *  \brief Counter based random numbers: the i-th number of a stream is a hash
+ *  of the key of the stream and i, there is no state besides the counter.
+ *
+ *  A stream is identified by a seed and a stream number, e.g. the PE and the
+ *  number of the operator call, or a block of a parallel loop. If each block
+ *  (not each thread) owns its stream, the result depends neither on the number
+ *  of threads nor on the scheduling. The hash is the finalizer of SplitMix64.
+ *
+ *  Satisfies the UniformRandomBitGenerator requirements, so it can be used
+ *  with std::shuffle and the distributions of <random>.
+ */
+class CounterRandom
+{
+    public:
+        typedef uint32_t result_type;
+
+        CounterRandom(uint64_t seed, uint64_t stream)
+            : m_key(mix(mix(seed) + stream)), m_counter(0) {}
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+        /// Next number of the stream.
+        result_type operator()() { return static_cast<result_type>(at(m_counter++) >> 32); }
+
+        /// The i-th (64 bit) number of the stream, independent of operator().
+        uint64_t at(uint64_t i) const { return mix(m_key + (i + 1) * GOLDEN_GAMMA); }
+
+        /**
+            \brief Returns the stream "stream" below this one, e.g. for the blocks of a
+            parallel loop. Does not change this stream, so it can be called concurrently.
+         */
+        CounterRandom split(uint64_t stream) const { return CounterRandom(m_key, stream); }
+
+    protected:
+        static const uint64_t GOLDEN_GAMMA = 0x9E3779B97F4A7C15ULL;
+
+        static uint64_t mix(uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+            return x ^ (x >> 31);
+        }
+
+        /// Hash of the seed and the stream number.
+        uint64_t m_key;
+        /// Numbers drawn by operator().
+        uint64_t m_counter;
+};
+
+#endif // COUNTERRANDOM_H
@@ -16,17 +16,20 @@
 using namespace std;
 
 ModularityMetric::ModularityMetric(graph_access &G)
-    : m_G(G)
+    : m_G(&G)
 {
     // initialize own data structures
-    ModularityMetric::computeEdgeWeightsPerCluster(m_G, m_edgeWeightsPerCluster, m_weightedEdgeEndsPerCluster);
+    ModularityMetric::computeEdgeWeightsPerCluster(G, m_edgeWeightsPerCluster, m_weightedEdgeEndsPerCluster);
     // we store it as double, because we need it always as a double
-    m_sumOfAllEdgeWeights = static_cast<double>(ModularityMetric::computeSumOfAllEdgeWeights(m_G));
+    m_sumOfAllEdgeWeights = static_cast<double>(ModularityMetric::computeSumOfAllEdgeWeights(G));
 
     // cache the node degrees
     this->computeWeightedNodeDegrees();
+
+    this->computeQualitySums();
 }
 
+
 ModularityMetric::~ModularityMetric()
 {
     //dtor
@@ -35,23 +38,9 @@ ModularityMetric::~ModularityMetric()
 
 double ModularityMetric::quality() const
 {
-    double modularity = 0.0;
-
-    for (NodeID i = 0, iEnd = m_weightedEdgeEndsPerCluster.size(); i < iEnd; ++i)
-    {
-        EdgeWeight weightedEdgeEnds = m_weightedEdgeEndsPerCluster[i];
-
-        // we do not take care for empty clusters
-        if (weightedEdgeEnds > 0)
-        {
-            double edgeFraction = static_cast<double>(m_edgeWeightsPerCluster[i]) / m_sumOfAllEdgeWeights;
-            double edgeEndFraction = static_cast<double>(weightedEdgeEnds) / m_sumOfAllEdgeWeights;
-
-            modularity += edgeFraction - edgeEndFraction * edgeEndFraction;
-        }
-    }
-
-    return modularity;
+    // sum over the clusters c of e_c / W - (a_c / W)^2, empty clusters add nothing
+    return static_cast<double>(m_internalEdgeWeightSum) / m_sumOfAllEdgeWeights
+           - static_cast<double>(m_squaredEdgeEndsSum) / (m_sumOfAllEdgeWeights * m_sumOfAllEdgeWeights);
 }
 
 
@@ -70,9 +59,9 @@ void ModularityMetric::insertNode(NodeID node, PartitionID cluster, EdgeWeight e
 {
     EdgeWeight selfLoop = 0;
 
-    if (m_G.containsSelfLoops())
+    if (m_G->containsSelfLoops())
     {
-        selfLoop = m_G.getSelfLoop(node);
+        selfLoop = m_G->getSelfLoop(node);
     }
 
     this->insertNode(node, cluster, edgeWeightToCluster, selfLoop);
@@ -82,11 +71,10 @@ void ModularityMetric::insertNode(NodeID node, PartitionID cluster, EdgeWeight e
 
 void ModularityMetric::insertNode(NodeID node, PartitionID cluster, EdgeWeight edgeWeightToCluster, EdgeWeight selfLoop)
 {
-    m_edgeWeightsPerCluster[cluster] += 2 * edgeWeightToCluster + selfLoop;
-    m_weightedEdgeEndsPerCluster[cluster] += m_G.getWeightedNodeDegree(node) + selfLoop;
+    updateCluster(cluster, 2 * edgeWeightToCluster + selfLoop, m_G->getWeightedNodeDegree(node) + selfLoop);
 
     // assign to cluster
-    m_G.setPartitionIndex(node, cluster);
+    m_G->setPartitionIndex(node, cluster);
 }
 
 
@@ -94,9 +82,9 @@ void ModularityMetric::removeNode(NodeID node, PartitionID cluster, EdgeWeight e
 {
     EdgeWeight selfLoop = 0;
 
-    if (m_G.containsSelfLoops())
+    if (m_G->containsSelfLoops())
     {
-        selfLoop = m_G.getSelfLoop(node);
+        selfLoop = m_G->getSelfLoop(node);
     }
 
     this->removeNode(node, cluster, edgeWeightToCluster, selfLoop);
@@ -105,27 +93,55 @@ void ModularityMetric::removeNode(NodeID node, PartitionID cluster, EdgeWeight e
 
 void ModularityMetric::removeNode(NodeID node, PartitionID cluster, EdgeWeight edgeWeightToCluster, EdgeWeight selfLoop)
 {
-    m_edgeWeightsPerCluster[cluster] -= 2 * edgeWeightToCluster + selfLoop;
-    m_weightedEdgeEndsPerCluster[cluster] -= m_G.getWeightedNodeDegree(node) + selfLoop;
+    updateCluster(cluster, -(2 * edgeWeightToCluster + selfLoop), -(m_G->getWeightedNodeDegree(node) + selfLoop));
 
     // assign to invalid cluster
-    m_G.setPartitionIndex(node, -1);
+    m_G->setPartitionIndex(node, -1);
+}
+
+
+void ModularityMetric::updateCluster(PartitionID cluster, EdgeWeight edgeWeightDelta, EdgeWeight edgeEndsDelta)
+{
+    long long edgeEnds = m_weightedEdgeEndsPerCluster[cluster];
+    m_squaredEdgeEndsSum -= edgeEnds * edgeEnds;
+
+    m_edgeWeightsPerCluster[cluster] += edgeWeightDelta;
+    m_weightedEdgeEndsPerCluster[cluster] += edgeEndsDelta;
+
+    edgeEnds = m_weightedEdgeEndsPerCluster[cluster];
+    m_squaredEdgeEndsSum += edgeEnds * edgeEnds;
+    m_internalEdgeWeightSum += edgeWeightDelta;
+}
+
+
+void ModularityMetric::computeQualitySums()
+{
+    m_internalEdgeWeightSum = 0;
+    m_squaredEdgeEndsSum = 0;
+
+    for (NodeID i = 0, iEnd = m_weightedEdgeEndsPerCluster.size(); i < iEnd; ++i)
+    {
+        long long edgeEnds = m_weightedEdgeEndsPerCluster[i];
+
+        m_internalEdgeWeightSum += m_edgeWeightsPerCluster[i];
+        m_squaredEdgeEndsSum += edgeEnds * edgeEnds;
+    }
 }
 
 
 void ModularityMetric::computeWeightedNodeDegrees()
 {
-    bool hasGraphSelfLoops = m_G.containsSelfLoops();
+    bool hasGraphSelfLoops = m_G->containsSelfLoops();
 
-    m_weightedNodeDegrees.resize(m_G.number_of_nodes());
+    m_weightedNodeDegrees.resize(m_G->number_of_nodes());
 
-    forall_nodes(m_G, n)
+    forall_nodes((*m_G), n)
     {
-        EdgeWeight weightedDegree = m_G.getWeightedNodeDegree(n);
+        EdgeWeight weightedDegree = m_G->getWeightedNodeDegree(n);
 
         if (hasGraphSelfLoops)
         {
-            weightedDegree += m_G.getSelfLoop(n);
+            weightedDegree += m_G->getSelfLoop(n);
         }
 
         m_weightedNodeDegrees[n] = weightedDegree;
@@ -134,6 +150,23 @@ void ModularityMetric::computeWeightedNodeDegrees()
 
 
 // static members
+void ModularityMetric::computeEdgeWeightsPerCluster(graph_access& G,
+                                                    std::vector<EdgeWeight>& edgeWeightsPerCluster,
+                                                    std::vector<EdgeWeight>& weightedEdgeEndsPerCluster)
+{
+    // the graph readers record graphs without edge weights
+    if (G.hasUnitEdgeWeights())
+    {
+        computeEdgeWeightsPerCluster<true>(G, edgeWeightsPerCluster, weightedEdgeEndsPerCluster);
+    }
+    else
+    {
+        computeEdgeWeightsPerCluster<false>(G, edgeWeightsPerCluster, weightedEdgeEndsPerCluster);
+    }
+}
+
+
+template <bool UnitEdgeWeights>
 void ModularityMetric::computeEdgeWeightsPerCluster(graph_access& G,
                                                     std::vector<EdgeWeight>& edgeWeightsPerCluster,
                                                     std::vector<EdgeWeight>& weightedEdgeEndsPerCluster)
@@ -162,7 +195,7 @@ void ModularityMetric::computeEdgeWeightsPerCluster(graph_access& G,
         forall_out_edges(G, e, n)
         {
             PartitionID targetClusterIndex = G.getPartitionIndex(G.getEdgeTarget(e));
-            EdgeWeight edgeWeight = G.getEdgeWeight(e);
+            EdgeWeight edgeWeight = UnitEdgeWeights ? 1 : G.getEdgeWeight(e);
 
             if (sourceClusterIndex == targetClusterIndex)
             {
@@ -208,6 +241,121 @@ double ModularityMetric::computeModularity(graph_access &G)
     return modularity;
 }
 
+double ModularityMetric::computeModularity(graph_access &G, const std::vector<PartitionID> &clustering)
+{
+    double modularity = 0.0;
+    double sumOfEdgeWeights = static_cast<double>(computeSumOfAllEdgeWeights(G));
+    PartitionID clusterCount = 0;
+
+    forall_nodes(G, n)
+    {
+        clusterCount = max(clusterCount, clustering[n] + 1);
+    } endfor
+
+    vector<EdgeWeight> edgeWeightsPerCluster(clusterCount, 0);
+    vector<EdgeWeight> weightedEdgeEndsPerCluster(clusterCount, 0);
+
+    // same as computeEdgeWeightsPerCluster(), but on the given clustering
+    forall_nodes(G, n)
+    {
+        PartitionID sourceClusterIndex = clustering[n];
+
+        forall_out_edges(G, e, n)
+        {
+            EdgeWeight edgeWeight = G.getEdgeWeight(e);
+
+            if (sourceClusterIndex == clustering[G.getEdgeTarget(e)])
+            {
+                edgeWeightsPerCluster[sourceClusterIndex] += edgeWeight;
+            }
+
+            weightedEdgeEndsPerCluster[sourceClusterIndex] += edgeWeight;
+        } endfor
+
+        if (G.containsSelfLoops())
+        {
+            EdgeWeight selfLoop = G.getSelfLoop(n);
+            edgeWeightsPerCluster[sourceClusterIndex] += selfLoop;
+            weightedEdgeEndsPerCluster[sourceClusterIndex] += selfLoop;
+        }
+    } endfor
+
+    for (PartitionID c = 0; c < clusterCount; ++c)
+    {
+        double edgeFraction = static_cast<double>(edgeWeightsPerCluster[c]) / sumOfEdgeWeights;
+        double edgeEndFraction = static_cast<double>(weightedEdgeEndsPerCluster[c]) / sumOfEdgeWeights;
+
+        modularity += edgeFraction - edgeEndFraction * edgeEndFraction;
+    }
+
+    return modularity;
+}
+
+double ModularityMetric::computeModularity(const ClusteringGraph &G, const std::vector<PartitionID> &clustering)
+{
+    if (G.hasUnitEdgeWeights())
+    {
+        return computeModularity<true>(G, clustering);
+    }
+
+    return computeModularity<false>(G, clustering);
+}
+
+double ModularityMetric::computeModularity(const CompressedGraph &G, const std::vector<PartitionID> &clustering)
+{
+    if (G.hasUnitEdgeWeights())
+    {
+        return computeModularity<true>(G, clustering);
+    }
+
+    return computeModularity<false>(G, clustering);
+}
+
+template <bool UnitEdgeWeights, typename Graph>
+double ModularityMetric::computeModularity(const Graph &G, const std::vector<PartitionID> &clustering)
+{
+    double modularity = 0.0;
+    EdgeWeight sumOfEdgeWeights = 0;
+    PartitionID clusterCount = 0;
+
+    forall_nodes(G, n)
+    {
+        clusterCount = max(clusterCount, clustering[n] + 1);
+    } endfor
+
+    vector<EdgeWeight> edgeWeightsPerCluster(clusterCount, 0);
+    vector<EdgeWeight> weightedEdgeEndsPerCluster(clusterCount, 0);
+
+    forall_nodes(G, n)
+    {
+        PartitionID sourceClusterIndex = clustering[n];
+        EdgeWeight selfLoop = G.getSelfLoop(n);
+
+        forall_neighbors(G, n, target, weight, UnitEdgeWeights)
+        {
+            if (sourceClusterIndex == clustering[target])
+            {
+                edgeWeightsPerCluster[sourceClusterIndex] += weight;
+            }
+        } endfor
+
+        // the weighted degrees are stored in the graph
+        edgeWeightsPerCluster[sourceClusterIndex] += selfLoop;
+        weightedEdgeEndsPerCluster[sourceClusterIndex] += G.getWeightedNodeDegree(n) + selfLoop;
+        sumOfEdgeWeights += G.getWeightedNodeDegree(n) + selfLoop;
+    } endfor
+
+    for (PartitionID c = 0; c < clusterCount; ++c)
+    {
+        double edgeFraction = static_cast<double>(edgeWeightsPerCluster[c]) / sumOfEdgeWeights;
+        double edgeEndFraction = static_cast<double>(weightedEdgeEndsPerCluster[c]) / sumOfEdgeWeights;
+
+        modularity += edgeFraction - edgeEndFraction * edgeEndFraction;
+    }
+
+    return modularity;
+}
+
 double ModularityMetric::computeModularityBound(graph_access &G)
 {
     double modularity = 0.0;
@@ -8,6 +8,8 @@
 #ifndef MODULARITYMETRIC_H
 #define MODULARITYMETRIC_H
 
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
 #include "data_structure/graph_access.h"
 #include <vector>
 
@@ -18,17 +20,21 @@
  *  Static functions compute from scratch, member functions keep a
  *  state of the current clusters to calculate the modularity faster.
  *
- *  For weighted integer graphs.
+ *  For weighted integer graphs. The Louvain method on ClusteringGraphs uses
+ *  ObjectiveMetric (tools/objectivemetric.h) instead.
  */
 class ModularityMetric
 {
     public:
         ModularityMetric(graph_access &G);
+
         virtual ~ModularityMetric();
 
         /**
          *  \brief Returns the modularity of the given graph clustering.
          *
+         *  Maintained incrementally by insertNode() and removeNode(), takes constant time.
+         *
          *  \return Modularity in the range [-1,1].
          */
         double quality() const;
@@ -119,7 +125,23 @@ class ModularityMetric
          */
         static double computeModularity(graph_access &G);
         static double computeModularityBound(graph_access &G);
-        static double computeModularity(graph_access &G, int * partition_map);
+
+        /**
+         *  \brief Returns the modularity of the clustering "clustering" of G.
+         *
+         *  \param G Weighted graph to calculate the modularity for.
+         *  \param clustering Cluster of each node, the partition indices
+         *  of G are neither read nor changed (safe to call in parallel).
+         *
+         *  \return Modularity in the range [-1,1].
+         */
+        static double computeModularity(graph_access &G, const std::vector<PartitionID> &clustering);
+
+        /**
+         *  \brief Returns the modularity of the clustering "clustering" of G.
+         */
+        static double computeModularity(const ClusteringGraph &G, const std::vector<PartitionID> &clustering);
+        static double computeModularity(const CompressedGraph &G, const std::vector<PartitionID> &clustering);
 
 
         /**
@@ -156,6 +178,18 @@ class ModularityMetric
         void computeWeightedNodeDegrees();
 
 
+        /**
+         *  \brief Adds the deltas to the weights of cluster "cluster" and updates the sums for quality().
+         */
+        void updateCluster(PartitionID cluster, EdgeWeight edgeWeightDelta, EdgeWeight edgeEndsDelta);
+
+
+        /**
+         *  \brief Computes the sums for quality() from the cluster weights.
+         */
+        void computeQualitySums();
+
+
         /**
          *  \brief Computes the edges weights and weighted edge end points per cluster.
          *
@@ -171,6 +205,14 @@ class ModularityMetric
                                                  std::vector<EdgeWeight> &edgeWeightsPerCluster,
                                                  std::vector<EdgeWeight> &weightedEdgeEndsPerCluster);
 
+        /**
+         *  \brief computeEdgeWeightsPerCluster() for a graph known to have unit (or non-unit) edge weights.
+         */
+        template <bool UnitEdgeWeights>
+        static void computeEdgeWeightsPerCluster(graph_access &G,
+                                                 std::vector<EdgeWeight> &edgeWeightsPerCluster,
+                                                 std::vector<EdgeWeight> &weightedEdgeEndsPerCluster);
+
 
         /**
          *  \brief Returns self loop if v and w are the same, else returns out edge
@@ -178,10 +220,17 @@ class ModularityMetric
          */
         static EdgeWeight getWeightedOutEdgeToOtherNode(graph_access &G, NodeID v, NodeID w);
 
+        /**
+         *  \brief computeModularity() of a ClusteringGraph or CompressedGraph, instantiated
+         *  for unit or weighted edges.
+         */
+        template <bool UnitEdgeWeights, typename Graph>
+        static double computeModularity(const Graph &G, const std::vector<PartitionID> &clustering);
+
 
         // maybe make with this members an own class
         /// Graph of which we keep internally the modularity to answer modularity gains fast.
-        graph_access &m_G;
+        graph_access *m_G;
         /// Weight of edges inside/per cluster c. Source and target node are in the same cluster c. Size equal to cluster count.
         std::vector<EdgeWeight> m_edgeWeightsPerCluster;
         /// Weight of edge end points inside/per cluster c. Source node is in cluster c. Size equal to cluster count.
@@ -192,6 +241,10 @@ class ModularityMetric
             it does not change and is needed often (and graph_access has
             no such property.) */
         double m_sumOfAllEdgeWeights;
+        /// Sum of m_edgeWeightsPerCluster.
+        long long m_internalEdgeWeightSum;
+        /// Sum of the squares of m_weightedEdgeEndsPerCluster.
+        long long m_squaredEdgeEndsSum;
 
     private:
 };
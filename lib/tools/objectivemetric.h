@@ -0,0 +1,365 @@
+/******************************************************************************
+ * objectivemetric.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef OBJECTIVEMETRIC_H
+#define OBJECTIVEMETRIC_H
+
+#include "clustering/gainkernel.h"
+#include "data_structure/clusteringgraph.h"
+#include "data_structure/compressedgraph.h"
+#include <limits>
+#include <vector>
+
+
+/*
+ *  Objective policies for ObjectiveMetric. All objectives have the form
+ *
+ *      Q = 1/W * sum over the clusters c of (e_c - penalty * a_c^2)
+ *
+ *  W is the sum of all edge weights (both directions and the self loops),
+ *  e_c the weight of the edge ends inside cluster c and a_c the sum of the
+ *  volumes of the nodes in c. A policy defines the volume of a node, the gain
+ *  and the quality. The gain is the change of W*Q if a node joins a cluster,
+ *  halved and without the part that is the same for all clusters.
+ *
+ *  nodeVolume() has a template parameter that tells if the graph has unit node
+ *  weights, the kernels instantiate the unit version for such graphs. The graph
+ *  is a ClusteringGraph or a CompressedGraph.
+ *  penalty() is the factor of clusterVolume * nodeVolume in the gain, for the
+ *  vectorized gain kernel. EXACT_GAINS tells if W * gain is an integer, then
+ *  the gains can be compared without rounding.
+ */
+
+
+/**
+ *  \brief Modularity: the volume of a node is its weighted degree, penalty 1/W.
+ */
+class ModularityObjective
+{
+    public:
+        static const bool EXACT_GAINS = true;
+
+        ModularityObjective() : m_sumOfAllEdgeWeights(1.0) {}
+
+        template <bool UnitNodeWeights, typename Graph>
+        static EdgeWeight nodeVolume(const Graph &G, NodeID node)
+        {
+            return G.getWeightedNodeDegree(node) + G.getSelfLoop(node);
+        }
+
+        void setSumOfAllEdgeWeights(double sumOfAllEdgeWeights) { m_sumOfAllEdgeWeights = sumOfAllEdgeWeights; }
+
+        double gain(EdgeWeight edgeWeightToCluster, EdgeWeight clusterVolume, EdgeWeight nodeVolume) const
+        {
+            return static_cast<double>(edgeWeightToCluster)
+                   - static_cast<double>(clusterVolume) * static_cast<double>(nodeVolume) / m_sumOfAllEdgeWeights;
+        }
+
+        double penalty() const { return 1.0 / m_sumOfAllEdgeWeights; }
+
+        double quality(long long internalEdgeWeightSum, long long squaredVolumeSum) const
+        {
+            return static_cast<double>(internalEdgeWeightSum) / m_sumOfAllEdgeWeights
+                   - static_cast<double>(squaredVolumeSum) / (m_sumOfAllEdgeWeights * m_sumOfAllEdgeWeights);
+        }
+
+    protected:
+        double m_sumOfAllEdgeWeights;
+};
+
+
+/**
+ *  \brief Modularity with resolution parameter gamma, penalty gamma/W.
+ *
+ *  gamma > 1 gives smaller clusters, gamma < 1 larger ones.
+ */
+class ResolutionModularityObjective : public ModularityObjective
+{
+    public:
+        static const bool EXACT_GAINS = false;
+
+        explicit ResolutionModularityObjective(double resolution) : m_resolution(resolution) {}
+
+        double gain(EdgeWeight edgeWeightToCluster, EdgeWeight clusterVolume, EdgeWeight nodeVolume) const
+        {
+            return static_cast<double>(edgeWeightToCluster)
+                   - m_resolution * static_cast<double>(clusterVolume) * static_cast<double>(nodeVolume) / m_sumOfAllEdgeWeights;
+        }
+
+        double penalty() const { return m_resolution / m_sumOfAllEdgeWeights; }
+
+        double quality(long long internalEdgeWeightSum, long long squaredVolumeSum) const
+        {
+            return static_cast<double>(internalEdgeWeightSum) / m_sumOfAllEdgeWeights
+                   - m_resolution * static_cast<double>(squaredVolumeSum) / (m_sumOfAllEdgeWeights * m_sumOfAllEdgeWeights);
+        }
+
+    protected:
+        double m_resolution;
+};
+
+
+/**
+ *  \brief Constant Potts model: the volume of a node is its node weight, penalty gamma.
+ *
+ *  W*Q is twice sum over c of (E_c - gamma * n_c * (n_c - 1) / 2) plus a constant,
+ *  with E_c the edge weight inside c and n_c the node weight of c. Unlike modularity
+ *  it has no resolution limit. Coarse nodes carry the number of input nodes as weight.
+ */
+class ConstantPottsObjective
+{
+    public:
+        static const bool EXACT_GAINS = false;
+
+        explicit ConstantPottsObjective(double resolution)
+            : m_resolution(resolution), m_sumOfAllEdgeWeights(1.0) {}
+
+        template <bool UnitNodeWeights, typename Graph>
+        static EdgeWeight nodeVolume(const Graph &G, NodeID node)
+        {
+            return UnitNodeWeights ? 1 : static_cast<EdgeWeight>(G.getNodeWeight(node));
+        }
+
+        void setSumOfAllEdgeWeights(double sumOfAllEdgeWeights) { m_sumOfAllEdgeWeights = sumOfAllEdgeWeights; }
+
+        double gain(EdgeWeight edgeWeightToCluster, EdgeWeight clusterVolume, EdgeWeight nodeVolume) const
+        {
+            return static_cast<double>(edgeWeightToCluster)
+                   - m_resolution * static_cast<double>(clusterVolume) * static_cast<double>(nodeVolume);
+        }
+
+        double penalty() const { return m_resolution; }
+
+        double quality(long long internalEdgeWeightSum, long long squaredVolumeSum) const
+        {
+            return (static_cast<double>(internalEdgeWeightSum) - m_resolution * static_cast<double>(squaredVolumeSum))
+                   / m_sumOfAllEdgeWeights;
+        }
+
+    protected:
+        double m_resolution;
+        double m_sumOfAllEdgeWeights;
+};
+
+
+/**
+ *  \brief Keeps track of a clustering of a ClusteringGraph (or of a CompressedGraph,
+ *  see "Graph") and its quality under the objective policy "Objective" (see above).
+ *
+ *  Everything is inline, so the local moving kernels instantiated with a policy
+ *  do not pay for a function call per neighboring cluster.
+ *  insertNode() and removeNode() update "clustering".
+ *  Cluster IDs have to be smaller than the number of nodes.
+ */
+template <typename Objective, typename Graph = ClusteringGraph>
+class ObjectiveMetric
+{
+    public:
+        ObjectiveMetric(const Graph &G, std::vector<PartitionID> &clustering,
+                        const Objective &objective)
+            : m_G(&G), m_clustering(&clustering), m_objective(objective)
+        {
+            EdgeWeight sumOfAllEdgeWeights = 0;
+            bool unitNodeWeights = G.hasUnitNodeWeights();
+
+            m_edgeWeightsPerCluster.assign(G.number_of_nodes(), 0);
+            m_volumesPerCluster.assign(G.number_of_nodes(), 0);
+            m_internalEdgeWeightSum = 0;
+            m_squaredVolumeSum = 0;
+
+            if (G.hasUnitEdgeWeights())
+            {
+                addInternalEdgeWeights<true>(G, clustering);
+            }
+            else
+            {
+                addInternalEdgeWeights<false>(G, clustering);
+            }
+
+            forall_nodes(G, n)
+            {
+                PartitionID sourceClusterIndex = clustering[n];
+                EdgeWeight selfLoop = G.getSelfLoop(n);
+
+                m_edgeWeightsPerCluster[sourceClusterIndex] += selfLoop;
+                m_volumesPerCluster[sourceClusterIndex] += unitNodeWeights ? Objective::template nodeVolume<true>(G, n)
+                                                                           : Objective::template nodeVolume<false>(G, n);
+                sumOfAllEdgeWeights += G.getWeightedNodeDegree(n) + selfLoop;
+            } endfor
+
+            m_sumOfAllEdgeWeights = static_cast<double>(sumOfAllEdgeWeights);
+            m_objective.setSumOfAllEdgeWeights(m_sumOfAllEdgeWeights);
+            m_penalty = m_objective.penalty();
+            m_exactGainsPossible = Objective::EXACT_GAINS
+                                   && sumOfAllEdgeWeights <= std::numeric_limits<EdgeWeight>::max();
+
+            for (NodeID c = 0, cEnd = m_volumesPerCluster.size(); c < cEnd; ++c)
+            {
+                long long volume = m_volumesPerCluster[c];
+
+                m_internalEdgeWeightSum += m_edgeWeightsPerCluster[c];
+                m_squaredVolumeSum += volume * volume;
+            }
+        }
+
+        /**
+         *  \brief Returns the quality of the clustering, maintained incrementally (constant time).
+         */
+        double quality() const
+        {
+            return m_objective.quality(m_internalEdgeWeightSum, m_squaredVolumeSum);
+        }
+
+        /**
+         *  \brief Continues on the next finer level of a graph hierarchy.
+         *
+         *  "clustering" has to be the projection of the current clustering to "finer",
+         *  i.e. each node has the cluster ID of its coarse node. The cluster weights
+         *  and the quality do not change by the projection.
+         */
+        void projectTo(const Graph &finer, std::vector<PartitionID> &clustering)
+        {
+            m_G = &finer;
+            m_clustering = &clustering;
+
+            // the clusters keep their IDs, the finer graph has more nodes and thus
+            // possible cluster IDs
+            m_edgeWeightsPerCluster.resize(finer.number_of_nodes(), 0);
+            m_volumesPerCluster.resize(finer.number_of_nodes(), 0);
+        }
+
+        /**
+         *  \brief Volume of "node" in the objective (to pass to gain(), insertNode() and removeNode()).
+         */
+        template <bool UnitNodeWeights>
+        EdgeWeight nodeVolume(NodeID node) const
+        {
+            return Objective::template nodeVolume<UnitNodeWeights>(*m_G, node);
+        }
+
+        /**
+         *  \brief Returns the (not normalized) gain if a node with volume "nodeVolume"
+         *  would be added to cluster "cluster". Assumes that it is not in "cluster".
+         */
+        double gain(EdgeWeight nodeVolume, PartitionID cluster, EdgeWeight edgeWeightToCluster) const
+        {
+            return m_objective.gain(edgeWeightToCluster, m_volumesPerCluster[cluster], nodeVolume);
+        }
+
+        /**
+         *  \brief Returns the gain of a node with volume "nodeVolume" for its own cluster
+         *  "cluster", i.e. gain() as if it was removed from there.
+         */
+        double gainInOwnCluster(EdgeWeight nodeVolume, PartitionID cluster, EdgeWeight edgeWeightToCluster) const
+        {
+            return m_objective.gain(edgeWeightToCluster, m_volumesPerCluster[cluster] - nodeVolume, nodeVolume);
+        }
+
+        /**
+         *  \brief Returns the position of the neighboring cluster with the maximum gain
+         *  for a node with volume "nodeVolume", -1 if no gain is positive.
+         *
+         *  The neighborhood is given as contiguous arrays with "count" entries, see
+         *  GainKernel. With "exact" the gains are compared as integers, if the
+         *  objective allows it (plain modularity, sum of all edge weights fits
+         *  into an EdgeWeight).
+         */
+        int findBestNeighbor(EdgeWeight nodeVolume, const PartitionID *clusters,
+                             const EdgeWeight *edgeWeights, NodeID count, bool exact) const
+        {
+            if (exact && m_exactGainsPossible)
+            {
+                return GainKernel::findBestNeighborExact(clusters, edgeWeights, count, &m_volumesPerCluster[0],
+                                                         static_cast<EdgeWeight>(m_sumOfAllEdgeWeights), nodeVolume);
+            }
+
+            return GainKernel::findBestNeighbor(clusters, edgeWeights, count, &m_volumesPerCluster[0],
+                                                m_penalty * static_cast<double>(nodeVolume));
+        }
+
+        /**
+         *  \brief Inserts node "node" to cluster "cluster".
+         *
+         *  Assumes that "node" is not contained in "cluster" before.
+         */
+        void insertNode(NodeID node, EdgeWeight nodeVolume, PartitionID cluster,
+                        EdgeWeight edgeWeightToCluster, EdgeWeight selfLoop)
+        {
+            updateCluster(cluster, 2 * edgeWeightToCluster + selfLoop, nodeVolume);
+            (*m_clustering)[node] = cluster;
+        }
+
+        /**
+         *  \brief Removes node "node" from cluster "cluster".
+         *
+         *  Assumes that "node" is contained in "cluster" before.
+         *  Afterwards "node" belongs to cluster -1.
+         */
+        void removeNode(NodeID node, EdgeWeight nodeVolume, PartitionID cluster,
+                        EdgeWeight edgeWeightToCluster, EdgeWeight selfLoop)
+        {
+            updateCluster(cluster, -(2 * edgeWeightToCluster + selfLoop), -nodeVolume);
+            (*m_clustering)[node] = -1;
+        }
+
+    protected:
+        /**
+         *  \brief Adds the weights of the edges inside the clusters to m_edgeWeightsPerCluster.
+         */
+        template <bool UnitEdgeWeights>
+        void addInternalEdgeWeights(const Graph &G, const std::vector<PartitionID> &clustering)
+        {
+            forall_nodes(G, n)
+            {
+                PartitionID sourceClusterIndex = clustering[n];
+
+                forall_neighbors(G, n, target, weight, UnitEdgeWeights)
+                {
+                    if (sourceClusterIndex == clustering[target])
+                    {
+                        m_edgeWeightsPerCluster[sourceClusterIndex] += weight;
+                    }
+                } endfor
+            } endfor
+        }
+
+        /**
+         *  \brief Adds the deltas to the weights of cluster "cluster" and updates the sums for quality().
+         */
+        void updateCluster(PartitionID cluster, EdgeWeight edgeWeightDelta, EdgeWeight volumeDelta)
+        {
+            long long volume = m_volumesPerCluster[cluster];
+            m_squaredVolumeSum -= volume * volume;
+
+            m_edgeWeightsPerCluster[cluster] += edgeWeightDelta;
+            m_volumesPerCluster[cluster] += volumeDelta;
+
+            volume = m_volumesPerCluster[cluster];
+            m_squaredVolumeSum += volume * volume;
+            m_internalEdgeWeightSum += edgeWeightDelta;
+        }
+
+        const Graph *m_G;
+        std::vector<PartitionID> *m_clustering;
+        Objective m_objective;
+        /// Weight of the edge ends inside cluster c (both directions and self loops).
+        std::vector<EdgeWeight> m_edgeWeightsPerCluster;
+        /// Sum of the node volumes of cluster c.
+        std::vector<EdgeWeight> m_volumesPerCluster;
+        /// Sum of all edge weights (both directions and self loops).
+        double m_sumOfAllEdgeWeights;
+        /// Objective::penalty(), computed once.
+        double m_penalty;
+        /// TRUE, if findBestNeighbor() can compare the gains as integers.
+        bool m_exactGainsPossible;
+        /// Sum of m_edgeWeightsPerCluster.
+        long long m_internalEdgeWeightSum;
+        /// Sum of the squares of m_volumesPerCluster.
+        long long m_squaredVolumeSum;
+};
+
+#endif // OBJECTIVEMETRIC_H
@@ -16,6 +16,7 @@
 #define MPI_MIN 3
 #define MPI_ANY_SOURCE -1
 #define MPI_ANY_TAG -1
+#define MPI_IN_PLACE ((void *) 1)
 
 // Types
 typedef int MPI_Comm;
@@ -107,7 +108,7 @@ inline int MPI_Sendrecv(const void *sendbuf, int sendcount, MPI_Datatype sendtyp
 inline int MPI_Bcast(void *buffer, int count, MPI_Datatype datatype, int root, MPI_Comm comm) { return MPI_SUCCESS; }
 inline int MPI_Allreduce(const void *sendbuf, void *recvbuf, int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
     // For single process, just copy if different buffers
-    if (sendbuf != recvbuf && sendbuf != NULL && recvbuf != NULL) {
+    if (sendbuf != recvbuf && sendbuf != MPI_IN_PLACE && sendbuf != NULL && recvbuf != NULL) {
         size_t size = count;
         if (datatype == MPI_INT) size *= sizeof(int);
         else if (datatype == MPI_DOUBLE) size *= sizeof(double);
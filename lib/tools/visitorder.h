@@ -0,0 +1,123 @@
+/******************************************************************************
+ * visitorder.h
+ *
+ * Source of VieClus -- Vienna Graph Clustering
+ *****************************************************************************/
+
+
+#ifndef VISITORDER_H
+#define VISITORDER_H
+
+#include "data_structure/graph_access.h"
+#include "tools/random_functions.h"
+
+#include <algorithm>
+#include <vector>
+
+
+/**
+ *  \brief Randomized visiting orders of the nodes for the local move phases.
+ */
+class VisitOrder
+{
+    public:
+        /// Nodes between the visited node and the node whose neighbors are prefetched.
+        static const NodeID PREFETCH_DISTANCE = 4;
+
+        /**
+            \brief Block randomized order of the nodes of G.
+
+            The node range is split into consecutive blocks of about blockEdges
+            out edges, so the adjacency of a block stays in the cache while
+            its nodes are visited. The blocks are visited in random order and
+            the nodes inside a block are visited in random order.
+
+            G is not changed. It is taken by non-const reference because the
+            accessors of graph_access are not const, for a const ClusteringGraph
+            Graph is deduced as the const type.
+
+            \param order Computed order (size: number of nodes).
+            \param randomIndex Called with a size s, returns a random value in [0, s).
+         */
+        template <typename Graph, typename NodeType, typename RandomIndex>
+        static void blockPermutation(Graph &G, EdgeID blockEdges,
+                                     std::vector<NodeType> &order, RandomIndex randomIndex)
+        {
+            /// first node of each block, plus the end of the node range
+            std::vector<NodeID> blockBegin(1, 0);
+            EdgeID edgesInBlock = 0;
+
+            forall_nodes(G, node)
+            {
+                edgesInBlock += G.getNodeDegree(node);
+
+                if (edgesInBlock >= blockEdges)
+                {
+                    blockBegin.push_back(node + 1);
+                    edgesInBlock = 0;
+                }
+            } endfor
+
+            if (blockBegin.back() != G.number_of_nodes())
+            {
+                blockBegin.push_back(G.number_of_nodes());
+            }
+
+            std::vector<NodeID> blocks(blockBegin.size() - 1);
+            for (NodeID b = 0; b < blocks.size(); ++b)
+            {
+                blocks[b] = b;
+            }
+            shuffle(blocks, 0, blocks.size(), randomIndex);
+
+            order.resize(G.number_of_nodes());
+            NodeID position = 0;
+
+            for (NodeID b = 0; b < blocks.size(); ++b)
+            {
+                NodeID begin = position;
+
+                for (NodeID node = blockBegin[blocks[b]]; node < blockBegin[blocks[b] + 1]; ++node)
+                {
+                    order[position++] = node;
+                }
+                shuffle(order, begin, position, randomIndex);
+            }
+        }
+
+        /**
+            \brief blockPermutation() with random_functions as random number generator.
+         */
+        template <typename Graph, typename NodeType>
+        static void blockPermutation(Graph &G, EdgeID blockEdges, std::vector<NodeType> &order)
+        {
+            blockPermutation(G, blockEdges, order,
+                             [](NodeID size) -> NodeID { return random_functions::nextInt(0, size - 1); });
+        }
+
+        /**
+            \brief Prefetches the neighbors of the node that is visited
+            PREFETCH_DISTANCE steps after position i of order.
+         */
+        template <typename Graph, typename NodeType>
+        static void prefetchAhead(const Graph &G, const std::vector<NodeType> &order, NodeID i)
+        {
+            if (i + PREFETCH_DISTANCE < order.size())
+            {
+                G.prefetchNeighbors(order[i + PREFETCH_DISTANCE]);
+            }
+        }
+
+    private:
+        /// Fisher-Yates shuffle of vec[begin, end).
+        template <typename T, typename RandomIndex>
+        static void shuffle(std::vector<T> &vec, NodeID begin, NodeID end, RandomIndex &randomIndex)
+        {
+            for (NodeID i = end; i > begin + 1; --i)
+            {
+                std::swap(vec[i - 1], vec[begin + randomIndex(i - begin)]);
+            }
+        }
+};
+
+#endif // VISITORDER_H